@@ -0,0 +1,124 @@
+/*
+ -------------------------------------------------------------------------------
+    This file is part of the Private Message Database.
+    Copyright (C) 2026  Dirk Stolle
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ -------------------------------------------------------------------------------
+*/
+
+#ifndef PMDB_BOUNDEDQUEUE_HPP
+#define PMDB_BOUNDEDQUEUE_HPP
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+
+namespace pmdb::parallel
+{
+
+/** \brief Queue with a fixed capacity that passes items between threads.
+ *
+ * \remarks Producers block while the queue is full, consumers block while the
+ *          queue is empty. After close() no more items can be pushed, and
+ *          consumers get the remaining items before pop() returns false.
+ */
+template<typename T>
+class BoundedQueue
+{
+  public:
+    /** \brief Creates an empty queue.
+     *
+     * \param capacity  maximum number of items in the queue, at least one
+     */
+    explicit BoundedQueue(const std::size_t capacity)
+    : m_Capacity(capacity == 0 ? 1 : capacity),
+      m_Items(),
+      m_Closed(false),
+      m_Mutex(),
+      m_NotFull(),
+      m_NotEmpty()
+    {
+    }
+
+
+    BoundedQueue(const BoundedQueue& other) = delete;
+    BoundedQueue& operator=(const BoundedQueue& other) = delete;
+
+
+    /** \brief Adds an item to the end of the queue, waits while the queue is full.
+     *
+     * \param item  the item to add
+     * \return Returns true, if the item was added.
+     *         Returns false, if the queue has been closed.
+     */
+    bool push(T&& item)
+    {
+      std::unique_lock<std::mutex> lock(m_Mutex);
+      m_NotFull.wait(lock, [this] { return m_Closed || (m_Items.size() < m_Capacity); });
+      if (m_Closed)
+        return false;
+      m_Items.push_back(std::move(item));
+      lock.unlock();
+      m_NotEmpty.notify_one();
+      return true;
+    }
+
+
+    /** \brief Removes the first item from the queue, waits while the queue is
+     *         empty and not closed.
+     *
+     * \param item  variable that receives the item
+     * \return Returns true, if an item was removed.
+     *         Returns false, if the queue is closed and empty.
+     */
+    bool pop(T& item)
+    {
+      std::unique_lock<std::mutex> lock(m_Mutex);
+      m_NotEmpty.wait(lock, [this] { return m_Closed || !m_Items.empty(); });
+      if (m_Items.empty())
+        return false;
+      item = std::move(m_Items.front());
+      m_Items.pop_front();
+      lock.unlock();
+      m_NotFull.notify_one();
+      return true;
+    }
+
+
+    /** \brief Closes the queue, so that no more items can be pushed. Waiting
+     *         threads are woken up.
+     */
+    void close()
+    {
+      {
+        const std::lock_guard<std::mutex> guard(m_Mutex);
+        m_Closed = true;
+      }
+      m_NotFull.notify_all();
+      m_NotEmpty.notify_all();
+    }
+  private:
+    const std::size_t m_Capacity;
+    std::deque<T> m_Items;
+    bool m_Closed;
+    std::mutex m_Mutex;
+    std::condition_variable m_NotFull;
+    std::condition_variable m_NotEmpty;
+}; // class
+
+} // namespace
+
+#endif // PMDB_BOUNDEDQUEUE_HPP
@@ -1,7 +1,7 @@
 /*
  -------------------------------------------------------------------------------
     This file is part of the Private Message Database.
-    Copyright (C) 2025  Dirk Stolle
+    Copyright (C) 2025, 2026  Dirk Stolle
 
     This program is free software: you can redistribute it and/or modify
     it under the terms of the GNU General Public License as published by
@@ -22,6 +22,7 @@
 #include <cstdint>
 #include <filesystem>
 #include <fstream>
+#include "MessagePack.hpp"
 #include "../libstriezel/hash/sha256/sha256.hpp"
 
 std::optional<Compression> detect_compression(const std::string& directory)
@@ -30,6 +31,19 @@ std::optional<Compression> detect_compression(const std::string& directory)
 
   std::error_code error;
 
+  // A message pack stores the compression of its records in its header.
+  const fs::path packPath = fs::path(directory) / pmdb::pack::packFileName;
+  if (fs::exists(packPath, error))
+  {
+    std::ifstream input(packPath, std::ios::in | std::ios::binary);
+    Compression compression = Compression::none;
+    if (!input.good() || !pmdb::pack::readHeader(input, compression))
+    {
+      return std::optional<Compression>();
+    }
+    return compression;
+  }
+
   auto iter = fs::directory_iterator(directory, fs::directory_options::skip_permission_denied, error);
   if (error)
   {
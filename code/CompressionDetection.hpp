@@ -1,7 +1,7 @@
 /*
  -------------------------------------------------------------------------------
     This file is part of the Private Message Database.
-    Copyright (C) 2025  Dirk Stolle
+    Copyright (C) 2025, 2026  Dirk Stolle
 
     This program is free software: you can redistribute it and/or modify
     it under the terms of the GNU General Public License as published by
@@ -31,6 +31,8 @@
  * \param directory   the directory that contains the private messages
  * \return Returns the compression mode (none or zlib) in case of success.
  *         Returns an empty optional, if an error occurred.
+ * \remarks If the directory contains a message pack, the compression is
+ *          taken from the header of the pack.
  */
 std::optional<Compression> detect_compression(const std::string& directory);
 
@@ -0,0 +1,187 @@
+/*
+ -------------------------------------------------------------------------------
+    This file is part of the Private Message Database.
+    Copyright (C) 2026  Dirk Stolle
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ -------------------------------------------------------------------------------
+*/
+
+#include "Datestamp.hpp"
+#include "StringPool.hpp"
+
+namespace
+{
+
+/* Layout of a packed datestamp, from the most significant bit on: year
+   (14 bits), month, day, hour and minute (7 bits each), a flag for the
+   presence of seconds (1 bit), seconds (7 bits). All fields are taken from
+   fixed-width decimal digits, so comparing packed values gives the same
+   order as comparing the texts. */
+constexpr unsigned int fieldBits = 7;
+constexpr unsigned int secondsFlagShift = fieldBits;
+constexpr unsigned int minuteShift = secondsFlagShift + 1;
+constexpr unsigned int hourShift = minuteShift + fieldBits;
+constexpr unsigned int dayShift = hourShift + fieldBits;
+constexpr unsigned int monthShift = dayShift + fieldBits;
+constexpr unsigned int yearShift = monthShift + fieldBits;
+
+/// length of a datestamp without seconds, e.g. "2007-06-14 12:34"
+constexpr std::size_t shortLength = 16;
+
+/// length of a datestamp with seconds, e.g. "2007-06-14 12:34:56"
+constexpr std::size_t longLength = 19;
+
+/** \brief Reads a number of decimal digits.
+ *
+ * \param text    the text
+ * \param offset  position of the first digit
+ * \param count   number of digits
+ * \param value   will hold the value of the digits
+ * \return Returns true, if all characters are digits.
+ */
+bool readDigits(const std::string_view text, const std::size_t offset, const std::size_t count, std::uint64_t& value)
+{
+  value = 0;
+  for (std::size_t i = offset; i < offset + count; ++i)
+  {
+    if ((text[i] < '0') || (text[i] > '9'))
+      return false;
+    value = value * 10 + static_cast<std::uint64_t>(text[i] - '0');
+  }
+  return true;
+}
+
+/** \brief Writes a value as a number of decimal digits, with leading zeros.
+ *
+ * \param dest   the destination
+ * \param count  number of digits
+ * \param value  the value
+ */
+void writeDigits(char* dest, const std::size_t count, std::uint64_t value)
+{
+  for (std::size_t i = count; i > 0; --i)
+  {
+    dest[i - 1] = static_cast<char>('0' + value % 10);
+    value /= 10;
+  }
+}
+
+} // anonymous namespace
+
+Datestamp::Datestamp()
+: m_Packed(0),
+  m_Text(&pmdb::intern(std::string_view()))
+{
+}
+
+Datestamp::Datestamp(const std::string_view text)
+: m_Packed(0),
+  m_Text(nullptr)
+{
+  if (!pack(text, m_Packed))
+  {
+    m_Text = &pmdb::intern(text);
+  }
+}
+
+bool Datestamp::pack(const std::string_view text, std::uint64_t& packed)
+{
+  if ((text.size() != shortLength) && (text.size() != longLength))
+    return false;
+  if ((text[4] != '-') || (text[7] != '-') || (text[10] != ' ') || (text[13] != ':'))
+    return false;
+
+  std::uint64_t year = 0, month = 0, day = 0, hour = 0, minute = 0, second = 0;
+  if (!readDigits(text, 0, 4, year) || !readDigits(text, 5, 2, month)
+      || !readDigits(text, 8, 2, day) || !readDigits(text, 11, 2, hour)
+      || !readDigits(text, 14, 2, minute))
+    return false;
+  const bool hasSeconds = text.size() == longLength;
+  if (hasSeconds && ((text[16] != ':') || !readDigits(text, 17, 2, second)))
+    return false;
+
+  packed = (year << yearShift) | (month << monthShift) | (day << dayShift)
+         | (hour << hourShift) | (minute << minuteShift)
+         | (static_cast<std::uint64_t>(hasSeconds) << secondsFlagShift) | second;
+  return true;
+}
+
+std::string_view Datestamp::view(Buffer& buffer) const
+{
+  if (m_Text != nullptr)
+  {
+    return *m_Text;
+  }
+  constexpr std::uint64_t fieldMask = (1 << fieldBits) - 1;
+  char* text = buffer.data();
+  writeDigits(text, 4, m_Packed >> yearShift);
+  text[4] = '-';
+  writeDigits(text + 5, 2, (m_Packed >> monthShift) & fieldMask);
+  text[7] = '-';
+  writeDigits(text + 8, 2, (m_Packed >> dayShift) & fieldMask);
+  text[10] = ' ';
+  writeDigits(text + 11, 2, (m_Packed >> hourShift) & fieldMask);
+  text[13] = ':';
+  writeDigits(text + 14, 2, (m_Packed >> minuteShift) & fieldMask);
+  std::size_t size = shortLength;
+  if ((m_Packed >> secondsFlagShift) & 1)
+  {
+    text[16] = ':';
+    writeDigits(text + 17, 2, m_Packed & fieldMask);
+    size = longLength;
+  }
+  text[size] = '\0';
+  return std::string_view(text, size);
+}
+
+std::string Datestamp::toString() const
+{
+  Buffer buffer;
+  return std::string(view(buffer));
+}
+
+std::size_t Datestamp::length() const
+{
+  if (m_Text != nullptr)
+    return m_Text->size();
+  return ((m_Packed >> secondsFlagShift) & 1) ? longLength : shortLength;
+}
+
+bool Datestamp::empty() const
+{
+  return (m_Text != nullptr) && m_Text->empty();
+}
+
+bool Datestamp::operator==(const Datestamp& other) const
+{
+  // A text that can be packed is always packed, and pooled texts are unique.
+  return (m_Text == other.m_Text) && ((m_Text != nullptr) || (m_Packed == other.m_Packed));
+}
+
+bool Datestamp::operator!=(const Datestamp& other) const
+{
+  return !(*this == other);
+}
+
+bool Datestamp::operator<(const Datestamp& other) const
+{
+  if ((m_Text == nullptr) && (other.m_Text == nullptr))
+  {
+    return m_Packed < other.m_Packed;
+  }
+  Buffer buffer;
+  Buffer otherBuffer;
+  return view(buffer) < other.view(otherBuffer);
+}
@@ -0,0 +1,109 @@
+/*
+ -------------------------------------------------------------------------------
+    This file is part of the Private Message Database.
+    Copyright (C) 2026  Dirk Stolle
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ -------------------------------------------------------------------------------
+*/
+
+#ifndef PMDB_DATESTAMP_HPP
+#define PMDB_DATESTAMP_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+/** Compact representation of the datestamp of a message.
+
+    Datestamps in the usual formats "YYYY-MM-DD HH:MM" and
+    "YYYY-MM-DD HH:MM:SS" are packed into a single integer, so that they need
+    no memory of their own. The integer is ordered like the text. Any other
+    datestamp is kept as text in the string pool (see StringPool.hpp).
+*/
+class Datestamp
+{
+  public:
+    /// buffer that is large enough for the text of any packed datestamp
+    typedef std::array<char, 20> Buffer;
+
+
+    /** \brief Creates an empty datestamp. */
+    Datestamp();
+
+
+    /** \brief Creates a datestamp from its text.
+     *
+     * \param text  the text of the datestamp
+     */
+    explicit Datestamp(const std::string_view text);
+
+
+    /** \brief Gets the text of the datestamp.
+     *
+     * \return Returns the datestamp as text, exactly as it was given.
+     */
+    std::string toString() const;
+
+
+    /** \brief Gets a view of the text of the datestamp.
+     *
+     * \param buffer  buffer that may be used for the text
+     * \return Returns a view of the text. The view is valid as long as the
+     *         buffer, and the character after its end is always NUL.
+     */
+    std::string_view view(Buffer& buffer) const;
+
+
+    /** \brief Gets the length of the text of the datestamp.
+     *
+     * \return Returns the number of characters in the text.
+     */
+    std::size_t length() const;
+
+
+    /** \brief Checks whether the datestamp is empty.
+     *
+     * \return Returns true, if the text of the datestamp is empty.
+     */
+    bool empty() const;
+
+
+    bool operator==(const Datestamp& other) const;
+    bool operator!=(const Datestamp& other) const;
+
+
+    /** \brief Compares two datestamps by their text.
+     *
+     * \param other  the other datestamp
+     * \return Returns true, if the text of this datestamp is less than the
+     *         text of the other datestamp.
+     */
+    bool operator<(const Datestamp& other) const;
+  private:
+    /** \brief Tries to pack the text of a datestamp.
+     *
+     * \param text    the text of the datestamp
+     * \param packed  will hold the packed value in case of success
+     * \return Returns true, if the text could be packed.
+     */
+    static bool pack(const std::string_view text, std::uint64_t& packed);
+
+    std::uint64_t m_Packed; /**< packed datestamp, only valid if m_Text is nullptr */
+    const std::string* m_Text; /**< pooled text, if the datestamp is not packed */
+}; // class
+
+#endif // PMDB_DATESTAMP_HPP
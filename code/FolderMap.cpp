@@ -1,7 +1,7 @@
 /*
  -------------------------------------------------------------------------------
     This file is part of the Private Message Database.
-    Copyright (C) 2014, 2016, 2025  Dirk Stolle
+    Copyright (C) 2014, 2016, 2025, 2026  Dirk Stolle
 
     This program is free software: you can redistribute it and/or modify
     it under the terms of the GNU General Public License as published by
@@ -40,6 +40,11 @@ bool FolderMap::hasEntry(const SHA256::MessageDigest& pm_digest) const
   return m_FolderMap.find(pm_digest) != m_FolderMap.end();
 }
 
+void FolderMap::remove(const SHA256::MessageDigest& pm_digest)
+{
+  m_FolderMap.erase(pm_digest);
+}
+
 const std::string& FolderMap::getFolderName(const SHA256::MessageDigest& pm_digest) const
 {
   const std::map<SHA256::MessageDigest, std::string>::const_iterator iter = m_FolderMap.find(pm_digest);
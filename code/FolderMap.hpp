@@ -1,7 +1,7 @@
 /*
  -------------------------------------------------------------------------------
     This file is part of the Private Message Database.
-    Copyright (C) 2014  Dirk Stolle
+    Copyright (C) 2014, 2026  Dirk Stolle
 
     This program is free software: you can redistribute it and/or modify
     it under the terms of the GNU General Public License as published by
@@ -51,6 +51,13 @@ class FolderMap
     bool hasEntry(const SHA256::MessageDigest& pm_digest) const;
 
 
+    /** \brief removes the folder entry of the PM with the given digest, if there is one
+     *
+     * \param pm_digest SHA256 hash of the message
+     */
+    void remove(const SHA256::MessageDigest& pm_digest);
+
+
     /** \brief returns the name of the folder wherein the message with the given
      *  digest resides, if it has a folder entry. Throws exception otherwise.
      *
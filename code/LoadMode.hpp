@@ -0,0 +1,35 @@
+/*
+ -------------------------------------------------------------------------------
+    This file is part of the Private Message Database.
+    Copyright (C) 2026  Dirk Stolle
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ -------------------------------------------------------------------------------
+*/
+
+#ifndef PMDB_LOADMODE_HPP
+#define PMDB_LOADMODE_HPP
+
+/// enumeration for the ways messages can be loaded from a directory
+enum class LoadMode: bool
+{
+  /// keep the complete messages in memory
+  Full = false,
+
+  /// keep only datestamp, title and users in memory, the message texts are
+  /// read again from the files when they are needed
+  Headers = true
+};
+
+#endif // PMDB_LOADMODE_HPP
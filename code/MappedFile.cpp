@@ -0,0 +1,135 @@
+/*
+ -------------------------------------------------------------------------------
+    This file is part of the Private Message Database.
+    Copyright (C) 2026  Dirk Stolle
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ -------------------------------------------------------------------------------
+*/
+
+#include "MappedFile.hpp"
+#include <limits>
+#if defined(_WIN32)
+  #include <windows.h>
+#else
+  #include <fcntl.h>
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+  #include <unistd.h>
+#endif
+
+MappedFile::MappedFile()
+: m_Data(nullptr),
+  m_Size(0)
+{
+}
+
+MappedFile::~MappedFile()
+{
+  close();
+}
+
+#if defined(_WIN32)
+bool MappedFile::open(const std::string& fileName)
+{
+  close();
+  HANDLE file = CreateFileA(fileName.c_str(), GENERIC_READ, FILE_SHARE_READ,
+                            nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (file == INVALID_HANDLE_VALUE)
+  {
+    return false;
+  }
+  LARGE_INTEGER fileSize;
+  if (!GetFileSizeEx(file, &fileSize)
+      || (static_cast<unsigned long long>(fileSize.QuadPart) > std::numeric_limits<std::size_t>::max()))
+  {
+    CloseHandle(file);
+    return false;
+  }
+  if (fileSize.QuadPart == 0)
+  {
+    CloseHandle(file);
+    return true;
+  }
+  HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  // The mapping keeps its own reference to the file.
+  CloseHandle(file);
+  if (mapping == nullptr)
+  {
+    return false;
+  }
+  void * view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+  // The view keeps its own reference to the mapping.
+  CloseHandle(mapping);
+  if (view == nullptr)
+  {
+    return false;
+  }
+  m_Data = static_cast<const char*>(view);
+  m_Size = static_cast<std::size_t>(fileSize.QuadPart);
+  return true;
+}
+
+void MappedFile::close()
+{
+  if (m_Data != nullptr)
+  {
+    UnmapViewOfFile(m_Data);
+  }
+  m_Data = nullptr;
+  m_Size = 0;
+}
+#else
+bool MappedFile::open(const std::string& fileName)
+{
+  close();
+  const int fd = ::open(fileName.c_str(), O_RDONLY);
+  if (fd == -1)
+  {
+    return false;
+  }
+  struct stat info;
+  if ((fstat(fd, &info) != 0) || !S_ISREG(info.st_mode)
+      || (static_cast<unsigned long long>(info.st_size) > std::numeric_limits<std::size_t>::max()))
+  {
+    ::close(fd);
+    return false;
+  }
+  if (info.st_size == 0)
+  {
+    ::close(fd);
+    return true;
+  }
+  void * memory = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  // The mapping stays valid after the file descriptor has been closed.
+  ::close(fd);
+  if (memory == MAP_FAILED)
+  {
+    return false;
+  }
+  m_Data = static_cast<const char*>(memory);
+  m_Size = static_cast<std::size_t>(info.st_size);
+  return true;
+}
+
+void MappedFile::close()
+{
+  if (m_Data != nullptr)
+  {
+    munmap(const_cast<char*>(m_Data), m_Size);
+  }
+  m_Data = nullptr;
+  m_Size = 0;
+}
+#endif
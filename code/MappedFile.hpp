@@ -0,0 +1,82 @@
+/*
+ -------------------------------------------------------------------------------
+    This file is part of the Private Message Database.
+    Copyright (C) 2026  Dirk Stolle
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ -------------------------------------------------------------------------------
+*/
+
+#ifndef PMDB_MAPPEDFILE_HPP
+#define PMDB_MAPPEDFILE_HPP
+
+#include <cstddef>
+#include <string>
+
+/** Maps the content of a file into memory for reading. */
+class MappedFile
+{
+  public:
+    /** \brief Creates an instance without a mapped file. */
+    MappedFile();
+
+
+    MappedFile(const MappedFile& other) = delete;
+    MappedFile& operator=(const MappedFile& other) = delete;
+
+
+    /** \brief Unmaps the file, if any. */
+    ~MappedFile();
+
+
+    /** \brief Maps a file into memory. A previously mapped file is unmapped.
+     *
+     * \param fileName  path of the file
+     * \return Returns true, if the file was mapped successfully.
+     *         Returns false, if an error occurred.
+     * \remarks Empty files can be "mapped", too. data() returns nullptr for
+     *          them and size() returns zero.
+     */
+    bool open(const std::string& fileName);
+
+
+    /** \brief Unmaps the current file. */
+    void close();
+
+
+    /** \brief Gets a pointer to the mapped file content.
+     *
+     * \return Returns a pointer to the first byte of the file, or nullptr if
+     *         no file or an empty file is mapped.
+     */
+    inline const char* data() const
+    {
+      return m_Data;
+    }
+
+
+    /** \brief Gets the size of the mapped file.
+     *
+     * \return Returns the size of the mapped file in bytes.
+     */
+    inline std::size_t size() const
+    {
+      return m_Size;
+    }
+  private:
+    const char* m_Data; /**< start of the mapped memory */
+    std::size_t m_Size; /**< size of the mapped memory in bytes */
+}; // class
+
+#endif // PMDB_MAPPEDFILE_HPP
@@ -1,7 +1,7 @@
 /*
  -------------------------------------------------------------------------------
     This file is part of the Private Message Database.
-    Copyright (C) 2012, 2013, 2014, 2015, 2016, 2025  Dirk Stolle
+    Copyright (C) 2012, 2013, 2014, 2015, 2016, 2025, 2026  Dirk Stolle
 
     This program is free software: you can redistribute it and/or modify
     it under the terms of the GNU General Public License as published by
@@ -20,31 +20,46 @@
 
 #include "MessageDatabase.hpp"
 #include <algorithm>
+#include <exception>
+#include <filesystem>
 #include <fstream>
 #include <iostream>
+#include <memory>
+#include <mutex>
+#include <random>
 #include <sstream>
 #include <stdexcept>
+#include <system_error>
+#include <thread>
+#include "BoundedQueue.hpp"
+#include "MappedFile.hpp"
+#include "MessagePack.hpp"
 #include "SortType.hpp"
-#include "XMLDocument.hpp"
-#include "XMLNode.hpp"
+#include "parallel.hpp"
+#include "sha256_backend.hpp"
+#include "VerificationCache.hpp"
+#include "XMLReader.hpp"
 #include "../libstriezel/common/DirectoryFileList.hpp"
 #include "../libstriezel/common/StringUtils.hpp"
 #include "../libstriezel/filesystem/directory.hpp"
-#include "../libstriezel/hash/sha256/BufferSourceUtility.hpp"
 
 MessageDatabase::MessageDatabase()
-:  m_Messages(std::map<SHA256::MessageDigest, PrivateMessage>())
+:  m_Messages(),
+   m_KnownFiles(std::map<std::string, KnownFiles>()),
+   m_Replaced(std::set<SHA256::MessageDigest>())
 {
 }
 
 bool MessageDatabase::addMessage(PrivateMessage& pm)
 {
-  if (m_Messages.find(pm.getHash()) != m_Messages.end())
-  {
-    return false;
-  }
-  m_Messages[pm.getHash()] = pm;
-  return true;
+  return m_Messages.insert(pm.getHash(), pm);
+}
+
+bool MessageDatabase::addMessage(PrivateMessage&& pm)
+{
+  // The digest has to be copied, because it is part of the moved message.
+  const SHA256::MessageDigest digest = pm.getHash();
+  return m_Messages.insert(digest, std::move(pm));
 }
 
 unsigned int MessageDatabase::getNumberOfMessages() const
@@ -54,71 +69,261 @@ unsigned int MessageDatabase::getNumberOfMessages() const
 
 bool MessageDatabase::hasMessage(PrivateMessage& pm) const
 {
-  return m_Messages.find(pm.getHash()) != m_Messages.end();
+  return m_Messages.contains(pm.getHash());
 }
 
 const PrivateMessage& MessageDatabase::getMessage(const SHA256::MessageDigest& digest) const
 {
-  const Iterator iter = m_Messages.find(digest);
-  if (iter != m_Messages.end())
+  const PrivateMessage* pm = m_Messages.find(digest);
+  if (pm != nullptr)
   {
-        return iter->second;
+        return *pm;
   }
   throw std::runtime_error("The message database has no message with the given hash "
                           + digest.toHexString() + "!");
 }
 
-bool MessageDatabase::importFromFile(const std::string& fileName, uint32_t& readPMs, uint32_t& newPMs, FolderMap& fm)
+bool MessageDatabase::importFromFile(const std::string& fileName, uint32_t& readPMs, uint32_t& newPMs, FolderMap& fm, const unsigned int jobs)
 {
   readPMs = 0;
   newPMs = 0;
-  // parse XML file
-  XMLDocument doc(fileName);
-  if (!doc.isParsed())
+  const auto insert = [this, &newPMs, &fm](PrivateMessage&& pm, const std::string& folder)
+  {
+    const SHA256::MessageDigest digest = pm.getHash();
+    // add message to DB
+    if (addMessage(std::move(pm)))
+    {
+      ++newPMs;
+    }
+    // add entry to folder map
+    if (!folder.empty())
+      fm.add(digest, folder);
+  };
+
+  const auto importOnCallingThread = [this, &fileName, &readPMs, &insert]()
+  {
+    return readXMLFile(fileName, readPMs, [&insert](PrivateMessage&& pm, const std::string& folder)
+    {
+      pm.normalise();
+      insert(std::move(pm), folder);
+    });
+  };
+
+  if (jobs <= 1)
+  {
+    return importOnCallingThread();
+  }
+
+  // Messages travel from the parser through the workers to the inserter.
+  struct ImportItem
+  {
+    std::size_t index = 0;
+    PrivateMessage pm;
+    std::string folder;
+  };
+  constexpr std::size_t queueCapacity = 256;
+  pmdb::parallel::BoundedQueue<ImportItem> parsed(queueCapacity);
+  pmdb::parallel::BoundedQueue<ImportItem> prepared(queueCapacity);
+  std::exception_ptr exception = nullptr;
+  std::mutex exceptionMutex;
+  const auto fail = [&]()
+  {
+    {
+      const std::lock_guard<std::mutex> guard(exceptionMutex);
+      if (exception == nullptr)
+        exception = std::current_exception();
+    }
+    parsed.close();
+    prepared.close();
+  };
+
+  const auto work = [&]()
+  {
+    try
+    {
+      ImportItem item;
+      while (parsed.pop(item))
+      {
+        item.pm.normalise();
+        // Calculate the hash here, so the inserter does not have to.
+        item.pm.getHash();
+        prepared.push(std::move(item));
+      }
+    }
+    catch (...)
+    {
+      fail();
+    }
+  };
+
+  const auto insertInOrder = [&]()
+  {
+    try
+    {
+      // Workers may finish out of order, but the folder map has to get the
+      // entries in the order of the file.
+      std::map<std::size_t, ImportItem> pending;
+      std::size_t next = 0;
+      ImportItem item;
+      while (prepared.pop(item))
+      {
+        pending.emplace(item.index, std::move(item));
+        auto iter = pending.begin();
+        while ((iter != pending.end()) && (iter->first == next))
+        {
+          insert(std::move(iter->second.pm), iter->second.folder);
+          iter = pending.erase(iter);
+          ++next;
+        }
+      }
+    }
+    catch (...)
+    {
+      fail();
+    }
+  };
+
+  // If the system cannot start all threads, the pipeline runs with fewer
+  // workers. Without any worker or without the inserter, the threads that
+  // did start are stopped and the calling thread does all the work.
+  const unsigned int workerCount = (jobs > 2) ? jobs - 2 : 1;
+  std::vector<std::thread> workers;
+  workers.reserve(workerCount);
+  std::thread inserter;
+  try
+  {
+    for (unsigned int i = 0; i < workerCount; ++i)
+    {
+      workers.emplace_back(work);
+    }
+  }
+  catch (const std::system_error&)
+  {
+    // Continue with the workers that have been started.
+  }
+  try
+  {
+    if (!workers.empty())
+    {
+      inserter = std::thread(insertInOrder);
+    }
+  }
+  catch (const std::system_error&)
+  {
+    // Handled below, because inserter is not joinable then.
+  }
+  if (!inserter.joinable())
+  {
+    parsed.close();
+    for (auto& worker: workers)
+    {
+      worker.join();
+    }
+    return importOnCallingThread();
+  }
+
+  std::size_t index = 0;
+  bool success = false;
+  try
+  {
+    success = readXMLFile(fileName, readPMs, [&parsed, &index](PrivateMessage&& pm, const std::string& folder)
+    {
+      ImportItem item;
+      item.index = index++;
+      item.pm = std::move(pm);
+      item.folder = folder;
+      parsed.push(std::move(item));
+    });
+  }
+  catch (...)
+  {
+    fail();
+  }
+  parsed.close();
+  for (auto& worker: workers)
+  {
+    worker.join();
+  }
+  prepared.close();
+  inserter.join();
+
+  if (exception != nullptr)
+  {
+    std::rethrow_exception(exception);
+  }
+  return success;
+}
+
+bool MessageDatabase::readXMLFile(const std::string& fileName, uint32_t& readPMs, const MessageSink& store)
+{
+  XMLReader reader(fileName);
+  if (!reader.isOpen())
   {
     std::cout << "Could not parse xml file!\n";
     return false;
   }
-  // We don't want (and cannot use) empty files.
-  if (doc.isEmpty())
+  // find root element
+  bool hasRoot = false;
+  while (reader.read())
   {
-    std::cout << "Empty xml document!\n";
-    return false;
+    if (reader.getNodeType() == XML_READER_TYPE_ELEMENT)
+    {
+      hasRoot = true;
+      break;
+    }
   }
-  XMLNode node = doc.getRootNode();
-  if (node.getNameAsString() != "privatemessages")
+  if (!hasRoot)
   {
-    std::cerr << "Root element's name is not \"privatemessages\" but \""
-              << node.getNameAsString() << "\" instead.\n";
+    if (reader.hasError())
+      std::cout << "Could not parse xml file!\n";
+    else
+      // We don't want (and cannot use) empty files.
+      std::cout << "Empty xml document!\n";
     return false;
   }
-  if (!node.hasChild())
+  if (reader.getName() != "privatemessages")
   {
-    std::cerr << "No child nodes after root node.\n";
+    std::cerr << "Root element's name is not \"privatemessages\" but \""
+              << reader.getName() << "\" instead.\n";
     return false;
   }
-  node = node.getChild();
 
-  while (node.hasNextSibling())
+  bool hasChild = false;
+  if (!reader.isEmptyElement())
   {
-    // folder node should be next, skip all text nodes
-    while (node.hasNextSibling() && !node.isElementNode())
+    while (reader.read() && (reader.getNodeType() != XML_READER_TYPE_END_ELEMENT))
     {
-      node = node.getNextSibling();
-    }
+      hasChild = true;
+      // folder element should be next, skip all text nodes
+      if (reader.getNodeType() != XML_READER_TYPE_ELEMENT)
+        continue;
 
-    if (node.getNameAsString() != "folder")
-    {
-      std::cerr << "Element's name is not \"folder\" but \"" << node.getNameAsString() << "\".\n";
-      return false;
-    }
+      if (reader.getName() != "folder")
+      {
+        std::cerr << "Element's name is not \"folder\" but \"" << reader.getName() << "\".\n";
+        return false;
+      }
 
-    if (!processFolderNode(node, readPMs, newPMs, fm))
-    {
-      std::cerr << "Error while processing folder!\n";
-      return false;
+      if (!processFolderNode(reader, readPMs, store))
+      {
+        std::cerr << "Error while processing folder!\n";
+        return false;
+      }
     }
-    node = node.getNextSibling();
+  }
+  if (!reader.hasError() && !hasChild)
+  {
+    std::cerr << "No child nodes after root node.\n";
+    return false;
+  }
+  // Read the rest of the document to detect errors after the root element.
+  while (reader.read())
+  {
+  }
+  if (reader.hasError())
+  {
+    std::cout << "Could not parse xml file!\n";
+    return false;
   }
   return true;
 }
@@ -133,70 +338,127 @@ MessageDatabase::Iterator MessageDatabase::getEnd() const
   return m_Messages.end();
 }
 
-bool MessageDatabase::processFolderNode(const XMLNode& node, uint32_t& readPMs, uint32_t& newPMs, FolderMap& fm)
+bool MessageDatabase::processFolderNode(XMLReader& reader, uint32_t& readPMs, const MessageSink& store)
 {
-  if (!node.hasChild())
+  if (reader.isEmptyElement())
   {
     return false;
   }
 
-  std::string folderName = "";
+  const std::string folderName = reader.getAttribute("name");
 
-  if (node.hasAttribute())
+  // get child elements - should be private messages
+  bool hasChild = false;
+  while (reader.read())
   {
-    if (node.getFirstAttributeName() == "name")
+    if (reader.getNodeType() == XML_READER_TYPE_END_ELEMENT)
     {
-      folderName = node.getFirstAttributeValue();
+      return hasChild;
     }
-  }
-
-  // get child node - should be private messages
-  XMLNode current = node.getChild();
-  while (current.hasNextSibling())
-  {
+    hasChild = true;
     // skip non-element nodes (i.e. text nodes, we want element nodes only)
-    while (current.hasNextSibling() && !current.isElementNode())
-    {
-      current = current.getNextSibling();
-    }
+    if (reader.getNodeType() != XML_READER_TYPE_ELEMENT)
+      continue;
 
-    if (current.getNameAsString() != "privatemessage")
+    if (reader.getName() != "privatemessage")
     {
       std::cerr << "Current node should have name \"privatemessage\", but it is \""
-                << current.getNameAsString() << "\" instead!\n";
+                << reader.getName() << "\" instead!\n";
       return false;
     }
-    if (!processPrivateMessageNode(current, readPMs, newPMs, folderName, fm))
+    if (!processPrivateMessageNode(reader, readPMs, folderName, store))
     {
       std::cerr << "Error while processing <privatemessage> element!\n";
       return false;
     }
+  }
+  // end of document or error before the end of the element
+  return false;
+}
+
+namespace
+{
 
-    current = current.getNextSibling();
+/** \brief Reads the text content of an element.
+ *
+ * \param reader        XML reader that is positioned at the start of the element
+ * \param acceptCDATA   whether the content may start with a CDATA section
+ * \param content       string that will hold the content of the element
+ * \return Returns true, if the content could be read. The reader is positioned
+ *         at the end of the element afterwards.
+ *         Returns false, if an error occurred.
+ * \remarks Only text and CDATA nodes directly below the element make up the
+ *          content. If the first child is of any other type (or a CDATA node,
+ *          although CDATA is not accepted), the content is empty.
+ */
+bool readTextContent(XMLReader& reader, const bool acceptCDATA, std::string& content)
+{
+  content.clear();
+  if (reader.isEmptyElement())
+    return true;
+
+  const int depth = reader.getDepth();
+  bool firstChild = true;
+  bool usable = true;
+  while (reader.read())
+  {
+    const int type = reader.getNodeType();
+    if ((type == XML_READER_TYPE_END_ELEMENT) && (reader.getDepth() == depth))
+    {
+      if (!usable)
+        content.clear();
+      return true;
+    }
+    if (reader.getDepth() != depth + 1)
+      continue;
+
+    const bool isText = (type == XML_READER_TYPE_TEXT)
+        || (type == XML_READER_TYPE_WHITESPACE)
+        || (type == XML_READER_TYPE_SIGNIFICANT_WHITESPACE);
+    const bool isCDATA = (type == XML_READER_TYPE_CDATA);
+    if (firstChild)
+    {
+      usable = isText || (acceptCDATA && isCDATA);
+      firstChild = false;
+    }
+    if (usable && (isText || isCDATA))
+    {
+      reader.appendValue(content);
+    }
   }
-  return true;
+  return false;
 }
 
-bool MessageDatabase::processPrivateMessageNode(const XMLNode& node, uint32_t& readPMs, uint32_t& newPMs, const std::string& folder, FolderMap& fm)
+} // anonymous namespace
+
+bool MessageDatabase::processPrivateMessageNode(XMLReader& reader, uint32_t& readPMs, const std::string& folder, const MessageSink& store)
 {
-  if (!node.hasChild())
+  if (reader.isEmptyElement())
   {
     return false;
   }
 
   PrivateMessage pm;
+  std::string content;
 
-  // get child node - should be private messages member data
-  XMLNode current = node.getChild();
-  while (current.hasNextSibling())
+  // get child elements - should be private messages member data
+  bool hasChild = false;
+  while (true)
   {
-    // skip non-element nodes (i.e. text nodes, we want element nodes only)
-    while (current.hasNextSibling() && !current.isElementNode())
+    if (!reader.read())
     {
-      current = current.getNextSibling();
+      return false;
     }
+    if (reader.getNodeType() == XML_READER_TYPE_END_ELEMENT)
+    {
+      break;
+    }
+    hasChild = true;
+    // skip non-element nodes (i.e. text nodes, we want element nodes only)
+    if (reader.getNodeType() != XML_READER_TYPE_ELEMENT)
+      continue;
 
-    const std::string curName = current.getNameAsString();
+    const std::string curName = reader.getName();
     if (curName == "datestamp")
     {
       if (!pm.getDatestamp().empty())
@@ -204,7 +466,9 @@ bool MessageDatabase::processPrivateMessageNode(const XMLNode& node, uint32_t& r
         std::cerr << "Error: More than one datestamp node in private message!\n";
         return false;
       }
-      pm.setDatestamp(current.getPlainTextContent());
+      if (!readTextContent(reader, false, content))
+        return false;
+      pm.setDatestamp(content);
     } // if "datestamp"
     else if (curName == "title")
     {
@@ -213,7 +477,9 @@ bool MessageDatabase::processPrivateMessageNode(const XMLNode& node, uint32_t& r
         std::cerr << "Error: More than one title node in private message!\n";
         return false;
       }
-      pm.setTitle(current.getContentBoth());
+      if (!readTextContent(reader, true, content))
+        return false;
+      pm.setTitle(std::move(content));
     } // if "title"
     else if (curName == "fromuser")
     {
@@ -222,7 +488,9 @@ bool MessageDatabase::processPrivateMessageNode(const XMLNode& node, uint32_t& r
         std::cerr << "Error: More than one fromuser node in private message!\n";
         return false;
       }
-      pm.setFromUser(current.getContentBoth());
+      if (!readTextContent(reader, true, content))
+        return false;
+      pm.setFromUser(content);
     } // if "fromuser"
     else if (curName == "fromuserid")
     {
@@ -232,12 +500,13 @@ bool MessageDatabase::processPrivateMessageNode(const XMLNode& node, uint32_t& r
         return false;
       }
 
-      const std::string temp = current.getPlainTextContent();
+      if (!readTextContent(reader, false, content))
+        return false;
       uint32_t tempUint;
-      if (!(std::stringstream (temp) >> tempUint)
-          || (std::to_string(tempUint) != temp))
+      if (!(std::stringstream (content) >> tempUint)
+          || (std::to_string(tempUint) != content))
       {
-        std::cerr << "Error: Could not convert \"" << temp << "\" to integer!\n";
+        std::cerr << "Error: Could not convert \"" << content << "\" to integer!\n";
         return false;
       }
       pm.setFromUserID(tempUint);
@@ -249,7 +518,9 @@ bool MessageDatabase::processPrivateMessageNode(const XMLNode& node, uint32_t& r
         std::cerr << "Error: More than one touser node in private message!\n";
         return false;
       }
-      pm.setToUser(current.getContentBoth());
+      if (!readTextContent(reader, true, content))
+        return false;
+      pm.setToUser(content);
     } // if "touser"
     else if (curName == "message")
     {
@@ -258,14 +529,19 @@ bool MessageDatabase::processPrivateMessageNode(const XMLNode& node, uint32_t& r
         std::cerr << "Error: More than one message node in private message!\n";
         return false;
       }
-      pm.setMessage(current.getContentBoth());
+      if (!readTextContent(reader, true, content))
+        return false;
+      pm.setMessage(std::move(content));
     } // if "message"
     else
     {
       std::cerr << "Error: Encountered unknown node named \"" << curName << "\".\n";
       return false;
     }
-    current = current.getNextSibling();
+  }
+  if (!hasChild)
+  {
+    return false;
   }
 
   // check data members
@@ -279,7 +555,7 @@ bool MessageDatabase::processPrivateMessageNode(const XMLNode& node, uint32_t& r
     std::cerr << "Error: PM title is empty!\n";
     return false;
   }
-  if (pm.getDatestamp().empty())
+  if (pm.getCompactDatestamp().empty())
   {
     std::cerr << "Error: PM datestamp is empty!\n";
     return false;
@@ -295,172 +571,733 @@ bool MessageDatabase::processPrivateMessageNode(const XMLNode& node, uint32_t& r
     return false;
   }
 
-  pm.normalise();
-
   ++readPMs;
-  // add message to DB
-  if (addMessage(pm))
-  {
-    ++newPMs;
-  }
-  // add entry to folder map
-  if (!folder.empty())
-    fm.add(pm.getHash(), folder);
+  store(std::move(pm), folder);
   return true;
 }
 
-bool MessageDatabase::saveMessages(const std::string& directory, const Compression compression) const
+bool MessageDatabase::saveMessages(const std::string& directory, const Compression compression, const unsigned int jobs, const SaveMode mode, const Storage storage)
 {
   const std::string realDirectory(libstriezel::filesystem::slashify(directory));
-  for (const auto& [hash, message]: m_Messages)
+  if (storage == Storage::Pack)
   {
-    if (!message.saveToFile(realDirectory + hash.toHexString(), compression))
+    if (!savePack(realDirectory, compression, jobs, mode))
     {
       return false;
     }
+    // All messages are in the pack now, so single files that were loaded
+    // earlier are not needed anymore.
+    KnownFiles& known = m_KnownFiles[realDirectory];
+    for (auto iter = known.digests.begin(); iter != known.digests.end(); )
+    {
+      std::error_code error;
+      std::filesystem::remove(realDirectory + iter->toHexString(), error);
+      if (error)
+      {
+        std::cerr << "Warning: Could not remove message file " << realDirectory
+                  << iter->toHexString() << " which is in the message pack now.\n";
+        ++iter;
+      }
+      else
+      {
+        iter = known.digests.erase(iter);
+      }
+    }
+    removeReplacedFiles(realDirectory);
+    return true;
+  }
+
+  if (!saveFiles(realDirectory, compression, jobs, mode))
+  {
+    return false;
+  }
+  removeReplacedFiles(realDirectory);
+  // Remove an existing pack, but only if all its messages exist as files now.
+  if (pmdb::pack::exists(realDirectory))
+  {
+    std::vector<pmdb::pack::IndexEntry> index;
+    if (pmdb::pack::readIndex(realDirectory, index)
+        && std::all_of(index.begin(), index.end(), [this](const pmdb::pack::IndexEntry& entry)
+           { return m_Messages.contains(entry.digest) || isReplaced(entry.digest); }))
+    {
+      if (!pmdb::pack::remove(realDirectory))
+      {
+        std::cerr << "Warning: Could not remove message pack in " << realDirectory
+                  << ", although all its messages have been saved as files.\n";
+      }
+    }
   }
   return true;
 }
 
-bool MessageDatabase::loadMessages(const std::string& directory, uint32_t& readPMs, uint32_t& newPMs, const Compression compression)
+bool MessageDatabase::saveFiles(const std::string& realDirectory, const Compression compression, const unsigned int jobs, const SaveMode mode)
 {
-  readPMs = 0;
-  newPMs = 0;
-  std::vector<FileEntry> files;
-  if (!getDirectoryFileList(directory, files, std::string(""), false))
+  KnownFiles& known = m_KnownFiles[realDirectory];
+  if (known.compression != compression)
   {
-    return false;
+    // Files with a different compression have to be overwritten.
+    known.digests.clear();
+    known.compression = compression;
   }
 
-  PrivateMessage tempPM;
+  // Messages are handed to the threads in batches of consecutive entries, so
+  // that the overhead per message stays small.
+  constexpr std::size_t batchSize = 64;
+  std::vector<const MessageStore::value_type*> entries;
+  entries.reserve(m_Messages.size());
+  for (const auto& entry: m_Messages)
+  {
+    if ((mode == SaveMode::Incremental) && (known.digests.find(entry.first) != known.digests.end()))
+    {
+      continue;
+    }
+    entries.push_back(&entry);
+  }
+  const std::size_t batches = (entries.size() + batchSize - 1) / batchSize;
 
-  const std::string realDirectory(libstriezel::filesystem::slashify(directory));
+  const std::size_t failure = pmdb::parallel::forEachIndex(batches, jobs,
+      [&](const std::size_t batch)
+      {
+        const std::size_t end = std::min(entries.size(), (batch + 1) * batchSize);
+        std::string fileName = realDirectory;
+        for (std::size_t idx = batch * batchSize; idx < end; ++idx)
+        {
+          fileName.resize(realDirectory.size());
+          fileName += entries[idx]->first.toHexString();
+          if (!entries[idx]->second.saveToFile(fileName, compression))
+          {
+            return false;
+          }
+        }
+        return true;
+      });
+  if (failure != batches)
+  {
+    return false;
+  }
+  for (const auto* entry: entries)
+  {
+    known.digests.insert(known.digests.end(), entry->first);
+  }
+  return true;
+}
 
-  for (const auto& entry: files)
+bool MessageDatabase::isReplaced(const SHA256::MessageDigest& digest) const
+{
+  return (m_Replaced.find(digest) != m_Replaced.end()) && !m_Messages.contains(digest);
+}
+
+void MessageDatabase::removeReplacedFiles(const std::string& realDirectory) const
+{
+  for (const auto& digest: m_Replaced)
   {
-    if (entry.IsDirectory)
+    if (!isReplaced(digest))
     {
       continue;
     }
-    if (!SHA256::isValidHash(entry.FileName))
+    std::error_code error;
+    std::filesystem::remove(realDirectory + digest.toHexString(), error);
+    if (error)
     {
-      continue;
+      std::cerr << "Warning: Could not remove message file " << realDirectory
+                << digest.toHexString() << " of a message that has been normalised.\n";
     }
-    if (!tempPM.loadFromFile(realDirectory + entry.FileName, compression))
+  }
+}
+
+bool MessageDatabase::savePack(const std::string& realDirectory, const Compression compression, const unsigned int jobs, const SaveMode mode) const
+{
+  const std::string packPath = realDirectory + pmdb::pack::packFileName;
+  const bool hasPack = pmdb::pack::exists(realDirectory);
+  // The existing pack is mapped into memory, because records of messages
+  // which have not been loaded have to be taken over into a rewritten pack.
+  MappedFile existingPack;
+  Compression packCompression = compression;
+  std::vector<pmdb::pack::IndexEntry> existing;
+  if (hasPack)
+  {
+    if (!existingPack.open(packPath) || !pmdb::pack::readHeader(existingPack.data(), existingPack.size(), packCompression))
     {
-      std::cerr << "Error while loading message from file \"" << realDirectory + entry.FileName << "\"!\n";
+      std::cerr << "Error: " << packPath << " is not a valid message pack!\n";
       return false;
     }
-    if (entry.FileName != tempPM.getHash().toHexString())
+    if (!pmdb::pack::readIndex(realDirectory, existing))
     {
-      std::cerr << "Error: Content of message file " << realDirectory + entry.FileName << " has been altered!\n";
+      std::cerr << "Error: Could not read index of message pack in " << realDirectory << "!\n";
       return false;
     }
-    ++readPMs;
-    if (addMessage(tempPM))
+    for (const auto& entry: existing)
     {
-      ++newPMs;
+      if ((entry.offset < pmdb::pack::headerSize) || (entry.offset > existingPack.size())
+          || (entry.size > existingPack.size() - entry.offset))
+      {
+        std::cerr << "Error: Index of message pack in " << realDirectory << " is corrupt!\n";
+        return false;
+      }
     }
   }
+  // Records with different compression cannot be mixed in one pack, and
+  // records of replaced messages can only be dropped by a rewrite.
+  const bool rewrite = (mode == SaveMode::Full) || !hasPack || (packCompression != compression)
+      || std::any_of(existing.begin(), existing.end(), [this](const pmdb::pack::IndexEntry& entry)
+         { return isReplaced(entry.digest); });
+
+  // A new pack is written to a temporary file first, so that the existing
+  // pack stays intact until the new one is complete.
+  const std::string targetPath = rewrite ? packPath + ".tmp" : packPath;
+  std::ofstream packStream;
+  std::uint64_t offset = 0;
+  if (rewrite)
+  {
+    packStream.open(targetPath, std::ios_base::out | std::ios_base::binary | std::ios_base::trunc);
+    if (!packStream || !pmdb::pack::writeHeader(packStream, compression))
+    {
+      std::cerr << "Error: Could not create message pack " << targetPath << "!\n";
+      return false;
+    }
+    offset = pmdb::pack::headerSize;
+  }
+  else
+  {
+    offset = existingPack.size();
+    existingPack.close();
+    packStream.open(packPath, std::ios_base::out | std::ios_base::binary | std::ios_base::app);
+    if (!packStream)
+    {
+      std::cerr << "Error: Could not open message pack " << packPath << " for writing!\n";
+      return false;
+    }
+  }
+
+  // A rewritten pack gets all messages of the database, plus the records of
+  // the existing pack whose messages are not in the database. Appending only
+  // adds the messages which are not in the pack yet.
+  std::vector<const MessageStore::value_type*> entries;
+  std::vector<pmdb::pack::IndexEntry> kept;
+  std::vector<pmdb::pack::IndexEntry> index;
+  if (rewrite)
+  {
+    for (const auto& entry: existing)
+    {
+      if (!m_Messages.contains(entry.digest) && !isReplaced(entry.digest))
+      {
+        kept.push_back(entry);
+      }
+    }
+  }
+  else
+  {
+    index = std::move(existing);
+  }
+  for (const auto& entry: m_Messages)
+  {
+    if (!pmdb::pack::contains(index, entry.first))
+    {
+      entries.push_back(&entry);
+    }
+  }
+
+  // Records are created (and compressed) in parallel, but written in order.
+  std::vector<std::string> records;
+  const auto writeRecords = [&](const std::size_t total, const auto& createRecord, const auto& digestOf)
+  {
+    const std::size_t chunkSize = 1024 * static_cast<std::size_t>(pmdb::parallel::workerCount(jobs, total));
+    for (std::size_t chunkStart = 0; chunkStart < total; chunkStart += chunkSize)
+    {
+      const std::size_t count = std::min(chunkSize, total - chunkStart);
+      records.assign(count, std::string());
+      const std::size_t failure = pmdb::parallel::forEachIndex(count, jobs,
+          [&](const std::size_t idx)
+          {
+            return createRecord(chunkStart + idx, records[idx]);
+          });
+      if (failure != count)
+      {
+        return false;
+      }
+      for (std::size_t idx = 0; idx < count; ++idx)
+      {
+        packStream.write(records[idx].c_str(), records[idx].length());
+        index.push_back({ digestOf(chunkStart + idx), offset, static_cast<std::uint32_t>(records[idx].length()) });
+        offset += records[idx].length();
+      }
+      if (!packStream.good())
+      {
+        return false;
+      }
+    }
+    return true;
+  };
+
+  // Kept records are copied as they are, unless the compression changes.
+  bool success = writeRecords(kept.size(),
+      [&](const std::size_t idx, std::string& record)
+      {
+        const char* data = existingPack.data() + kept[idx].offset;
+        if (packCompression == compression)
+        {
+          record.assign(data, kept[idx].size);
+          return true;
+        }
+        PrivateMessage pm;
+        return pm.loadFromBuffer(data, kept[idx].size, packCompression)
+            && pm.saveToBuffer(record, compression);
+      },
+      [&kept](const std::size_t idx) { return kept[idx].digest; });
+  existingPack.close();
+  const std::size_t existingEntries = index.size();
+  success = success && writeRecords(entries.size(),
+      [&entries, compression](const std::size_t idx, std::string& record)
+      {
+        return entries[idx]->second.saveToBuffer(record, compression);
+      },
+      [&entries](const std::size_t idx) { return entries[idx]->first; });
+  packStream.close();
+  success = success && packStream.good();
+  if (success)
+  {
+    // Existing and new entries are both sorted, because m_Messages is.
+    std::inplace_merge(index.begin(), index.begin() + existingEntries, index.end(),
+        [](const pmdb::pack::IndexEntry& a, const pmdb::pack::IndexEntry& b)
+        { return a.digest < b.digest; });
+    if (!rewrite)
+    {
+      // Old records are unchanged, so the old index stays valid until the
+      // new one replaces it.
+      success = pmdb::pack::writeIndex(realDirectory, index);
+    }
+    else if (pmdb::pack::prepareIndex(realDirectory, index))
+    {
+      // The new index is complete before the new pack replaces the old one,
+      // so that only the two renames remain which could leave an old index
+      // next to a new pack.
+      std::error_code error;
+      std::filesystem::rename(targetPath, packPath, error);
+      if (error)
+      {
+        success = false;
+      }
+      else if (!pmdb::pack::commitIndex(realDirectory))
+      {
+        std::cerr << "Error: The message pack in " << realDirectory << " has been"
+                  << " replaced, but its index could not be replaced by "
+                  << realDirectory << pmdb::pack::indexFileName << ".tmp!\n";
+        return false;
+      }
+    }
+    else
+    {
+      success = false;
+    }
+  }
+  if (!success)
+  {
+    std::cerr << "Error: Could not write messages to message pack in " << realDirectory << "!\n";
+    if (rewrite)
+    {
+      std::error_code error;
+      std::filesystem::remove(targetPath, error);
+      pmdb::pack::discardIndex(realDirectory);
+    }
+    return false;
+  }
   return true;
 }
 
-/**
- * Generates HTML code for the folder list.
+namespace
+{
+
+/** \brief Gets the offset of the messages which are hashed with
+ *         Verification::Sample.
  *
- * \param folderList  template for the folder list
- * \param folderEntry template for a folder entry in the list
- * \param folderContents  map of folder names to hashes + dates of PMs in that folder (just needed for the folder names here, i. e. the keys)
- * \param folderHashes    map of folder name to folder name's SHA-256 hash (in hexadecimal notation)
- * \param currentFolder   name of the current folder
- * \return Returns HTML code for the folder list.
+ * \return Returns a random value in [0; sampleInterval), so that every load
+ *         checks a different part of the messages.
  */
-std::string generateFolderList(MsgTemplate folderList, MsgTemplate folderEntry, const std::map<std::string, std::vector<SortType> >& folderContents, std::map<std::string, std::string> folderHashes, const std::string currentFolder)
+std::size_t randomSampleOffset()
 {
-  std::string theEntries = "";
-  std::map<std::string, std::vector<SortType> >::const_iterator iter = folderContents.begin();
-  while (iter != folderContents.end())
+  std::random_device device;
+  return std::uniform_int_distribution<std::size_t>(0, pmdb::verification::sampleInterval - 1)(device);
+}
+
+/** \brief Checks whether a message has to be hashed.
+ *
+ * \param verification  the requested verification
+ * \param index         index of the message in the list of messages to load
+ * \param offset        offset of the sample, see randomSampleOffset()
+ * \return Returns true, if the message has to be hashed.
+ */
+bool needsHashing(const Verification verification, const std::size_t index, const std::size_t offset)
+{
+  switch (verification)
+  {
+    case Verification::None:
+         return false;
+    case Verification::Sample:
+         return (index + offset) % pmdb::verification::sampleInterval == 0;
+    case Verification::Full:
+    default:
+         return true;
+  }
+}
+
+} // anonymous namespace
+
+bool MessageDatabase::loadPack(const std::string& realDirectory, uint32_t& readPMs, uint32_t& newPMs, const unsigned int jobs, const Verification verification, const LoadMode loadMode)
+{
+  const std::string packPath = realDirectory + pmdb::pack::packFileName;
+  std::vector<pmdb::pack::IndexEntry> index;
+  if (!pmdb::pack::readIndex(realDirectory, index))
+  {
+    std::cerr << "Error: Could not read index of message pack in " << realDirectory << "!\n";
+    return false;
+  }
+  // The pack is mapped into memory, so records are parsed without copying.
+  MappedFile packFile;
+  if (!packFile.open(packPath))
   {
-    if (iter->first != "")
+    std::cerr << "Error: Could not open message pack " << packPath << "!\n";
+    return false;
+  }
+  Compression packCompression = Compression::none;
+  if (!pmdb::pack::readHeader(packFile.data(), packFile.size(), packCompression))
+  {
+    std::cerr << "Error: " << packPath << " is not a valid message pack!\n";
+    return false;
+  }
+  for (const auto& entry: index)
+  {
+    if ((entry.offset < pmdb::pack::headerSize) || (entry.offset > packFile.size())
+        || (entry.size > packFile.size() - entry.offset))
     {
-      folderEntry.addReplacement("folder_link", "folder_" + folderHashes[iter->first] + ".html", false);
-      folderEntry.addReplacement("folder_name", iter->first, true);
-      folderEntry.addReplacement("marker", currentFolder == iter->first ? "&#x2714;" : "<span style=\"visibility: hidden;\">&#x2714;</span>", false);
-      theEntries += folderEntry.show();
+      std::cerr << "Error: Index of message pack in " << realDirectory << " is corrupt!\n";
+      return false;
     }
-    ++iter;
   }
 
-  // put entries into folder list
-  folderList.addReplacement("folder_entries", theEntries, false);
-  return folderList.show();
+  // Process records in the order of the pack file, so that memory is
+  // accessed sequentially.
+  std::sort(index.begin(), index.end(),
+      [](const pmdb::pack::IndexEntry& a, const pmdb::pack::IndexEntry& b)
+      { return a.offset < b.offset; });
+  m_Messages.reserve(m_Messages.size() + index.size());
+  const auto sharedPackPath = std::make_shared<const std::string>(packPath);
+
+  enum class LoadStatus { ok, readError, altered };
+
+  const std::size_t sampleOffset = randomSampleOffset();
+  const std::size_t chunkSize = 1024 * static_cast<std::size_t>(pmdb::parallel::workerCount(jobs, index.size()));
+  std::vector<PrivateMessage> chunk;
+  std::vector<LoadStatus> status;
+  for (std::size_t chunkStart = 0; chunkStart < index.size(); chunkStart += chunkSize)
+  {
+    const std::size_t count = std::min(chunkSize, index.size() - chunkStart);
+    chunk.assign(count, PrivateMessage());
+    status.assign(count, LoadStatus::ok);
+    const std::size_t failure = pmdb::parallel::forEachIndex(count, jobs,
+        [&](const std::size_t idx)
+        {
+          const pmdb::pack::IndexEntry& entry = index[chunkStart + idx];
+          if (!chunk[idx].loadFromBuffer(packFile.data() + entry.offset, entry.size, packCompression))
+          {
+            status[idx] = LoadStatus::readError;
+            return false;
+          }
+          if (!needsHashing(verification, chunkStart + idx, sampleOffset))
+          {
+            chunk[idx].setHash(entry.digest);
+          }
+          else if (chunk[idx].getHash() != entry.digest)
+          {
+            status[idx] = LoadStatus::altered;
+            return false;
+          }
+          if (loadMode == LoadMode::Headers)
+          {
+            chunk[idx].releaseMessage({ sharedPackPath, entry.offset, entry.size, packCompression, entry.digest });
+          }
+          return true;
+        });
+
+    for (std::size_t idx = 0; idx < failure; ++idx)
+    {
+      ++readPMs;
+      if (addMessage(std::move(chunk[idx])))
+      {
+        ++newPMs;
+      }
+    }
+    if (failure < count)
+    {
+      const std::string digest = index[chunkStart + failure].digest.toHexString();
+      if (status[failure] == LoadStatus::readError)
+        std::cerr << "Error while loading message " << digest << " from message pack " << packPath << "!\n";
+      else
+        std::cerr << "Error: Content of message " << digest << " in message pack " << packPath << " has been altered!\n";
+      return false;
+    }
+  }
+  return true;
 }
 
-bool MessageDatabase::saveIndexFiles(const std::string& directory, MsgTemplate index, MsgTemplate entry, MsgTemplate folderList, MsgTemplate folderEntry, const FolderMap& fm, const HTMLStandard standard) const
+bool MessageDatabase::loadMessages(const std::string& directory, uint32_t& readPMs, uint32_t& newPMs, const Compression compression, const unsigned int jobs, const Verification verification, const LoadMode loadMode)
 {
-  std::vector<SortType> sortedList;
-  for (const auto& [digest, pm]: m_Messages)
+  readPMs = 0;
+  newPMs = 0;
+  std::vector<FileEntry> files;
+  if (!getDirectoryFileList(directory, files, std::string(""), false))
   {
-    sortedList.push_back(SortType(pm.getDatestamp(), digest));
+    return false;
   }
-  // sort PM list by datestamps - newest first
-  std::sort(sortedList.begin(), sortedList.end(), ST_greater);
 
-  // create folder maps for later use
-  std::map<std::string, std::vector<SortType> > folderContents;
-  while (!sortedList.empty())
+  const std::string realDirectory(libstriezel::filesystem::slashify(directory));
+
+  std::vector<std::string> fileNames;
+  fileNames.reserve(files.size());
+  for (const auto& entry: files)
   {
-    if (fm.hasEntry(sortedList[0].md))
+    if (entry.IsDirectory)
     {
-      // add to folder
-      folderContents[fm.getFolderName(sortedList[0].md)].push_back(SortType(sortedList[0].datestamp, sortedList[0].md));
+      continue;
     }
-    else
+    if (!SHA256::isValidHash(entry.FileName))
     {
-      // no folder, so add it with "" as folder name
-      folderContents[""].push_back(SortType(sortedList[0].datestamp, sortedList[0].md));
+      continue;
     }
-    sortedList.erase(sortedList.begin());
+    fileNames.push_back(entry.FileName);
+  }
+  files.clear();
+  m_Messages.reserve(m_Messages.size() + fileNames.size());
+
+  KnownFiles& known = m_KnownFiles[realDirectory];
+  if (known.compression != compression)
+  {
+    known.digests.clear();
+    known.compression = compression;
+  }
+
+  // Files which have been hashed successfully before and which have not
+  // changed since then are not hashed again. The cache is not used at all,
+  // if the stored hashes are trusted anyway.
+  const bool useCache = verification != Verification::None;
+  pmdb::verification::Cache cache;
+  if (useCache)
+  {
+    pmdb::verification::readCache(realDirectory, compression, cache);
+  }
+  pmdb::verification::Cache verified;
+
+  // Released texts are read from the file named by their digest, so all
+  // messages share the path of the directory.
+  const auto sharedDirectory = std::make_shared<const std::string>(realDirectory);
+
+  enum class LoadStatus { ok, readError, altered };
+
+  // Files are processed in chunks, so that the number of messages which are
+  // held twice (in the chunk and in the database) stays limited.
+  const std::size_t sampleOffset = randomSampleOffset();
+  const std::size_t chunkSize = 1024 * static_cast<std::size_t>(pmdb::parallel::workerCount(jobs, fileNames.size()));
+  std::vector<PrivateMessage> chunk;
+  std::vector<LoadStatus> status;
+  std::vector<pmdb::verification::FileState> states;
+  std::vector<char> isVerified;
+  for (std::size_t chunkStart = 0; chunkStart < fileNames.size(); chunkStart += chunkSize)
+  {
+    const std::size_t count = std::min(chunkSize, fileNames.size() - chunkStart);
+    chunk.assign(count, PrivateMessage());
+    status.assign(count, LoadStatus::ok);
+    states.assign(count, pmdb::verification::FileState());
+    isVerified.assign(count, false);
+
+    const std::size_t failure = pmdb::parallel::forEachIndex(count, jobs,
+        [&](const std::size_t idx)
+        {
+          const std::string& fileName = fileNames[chunkStart + idx];
+          const std::string path = realDirectory + fileName;
+          SHA256::MessageDigest digest;
+          digest.fromHexString(fileName);
+          // The state is taken before the file is read, so a change during
+          // the read will be noticed the next time.
+          const bool hasState = useCache && pmdb::verification::getFileState(path, states[idx]);
+          if (!chunk[idx].loadFromFile(path, compression))
+          {
+            status[idx] = LoadStatus::readError;
+            return false;
+          }
+          if (hasState)
+          {
+            const auto cached = cache.find(digest);
+            isVerified[idx] = (cached != cache.end()) && (cached->second == states[idx]);
+          }
+          if (isVerified[idx] || !needsHashing(verification, chunkStart + idx, sampleOffset))
+          {
+            chunk[idx].setHash(digest);
+          }
+          else if (fileName != chunk[idx].getHash().toHexString())
+          {
+            status[idx] = LoadStatus::altered;
+            return false;
+          }
+          else
+          {
+            isVerified[idx] = hasState;
+          }
+          if (loadMode == LoadMode::Headers)
+          {
+            chunk[idx].releaseMessage({ sharedDirectory, 0, 0, compression, digest });
+          }
+          return true;
+        });
+
+    // Merge in the order of the file list, so that counters and the reported
+    // error are the same as with a single thread.
+    for (std::size_t idx = 0; idx < failure; ++idx)
+    {
+      if (isVerified[idx])
+      {
+        verified.emplace(chunk[idx].getHash(), states[idx]);
+      }
+      known.digests.insert(chunk[idx].getHash());
+      ++readPMs;
+      if (addMessage(std::move(chunk[idx])))
+      {
+        ++newPMs;
+      }
+    }
+    if (failure < count)
+    {
+      const std::string path = realDirectory + fileNames[chunkStart + failure];
+      if (status[failure] == LoadStatus::readError)
+        std::cerr << "Error while loading message from file \"" << path << "\"!\n";
+      else
+        std::cerr << "Error: Content of message file " << path << " has been altered!\n";
+      return false;
+    }
+  }
+
+  // Failing to write the cache is no error, the files will just be hashed
+  // again next time, e.g. when the directory is read-only.
+  if (useCache && (verified != cache))
+  {
+    pmdb::verification::writeCache(realDirectory, compression, verified);
+  }
+
+  if (pmdb::pack::exists(realDirectory))
+  {
+    return loadPack(realDirectory, readPMs, newPMs, jobs, verification, loadMode);
+  }
+  return true;
+}
+
+namespace
+{
+
+/// message that is listed in an index file
+struct IndexEntry
+{
+  std::string datestamp; /**< datestamp of the message */
+  std::string hexDigest; /**< digest of the message in hexadecimal notation */
+  const SHA256::MessageDigest* digest; /**< digest of the message */
+  const PrivateMessage* pm; /**< the message itself */
+};
+
+
+/// folder that gets its own index file
+struct IndexFolder
+{
+  std::string fileName; /**< name of the index file */
+  std::vector<const IndexEntry*> entries; /**< messages in the folder, newest first */
+  std::string listEntry; /**< entry of the folder in the folder list */
+  std::string currentListEntry; /**< entry of the folder in its own folder list */
+};
+
+/// marker of the current folder in the folder list
+const std::string currentFolderMarker = "&#x2714;";
+
+/// marker of the other folders in the folder list
+const std::string otherFolderMarker = "<span style=\"visibility: hidden;\">&#x2714;</span>";
+
+} // anonymous namespace
+
+bool MessageDatabase::saveIndexFiles(const std::string& directory, MsgTemplate index, MsgTemplate entry, MsgTemplate folderList, MsgTemplate folderEntry, const FolderMap& fm, const HTMLStandard standard) const
+{
+  std::vector<IndexEntry> sortedList;
+  sortedList.reserve(m_Messages.size());
+  for (const auto& [digest, pm]: m_Messages)
+  {
+    sortedList.push_back(IndexEntry{ pm.getDatestamp(), digest.toHexString(), &digest, &pm });
   }
+  // sort PM list by datestamps - newest first, same order as ST_greater()
+  std::sort(sortedList.begin(), sortedList.end(),
+      [](const IndexEntry& a, const IndexEntry& b)
+      {
+        const int cmp = a.datestamp.compare(b.datestamp);
+        if (cmp != 0)
+          return cmp > 0;
+        return a.hexDigest > b.hexDigest;
+      });
 
-  // folder hashes
-  std::map<std::string, std::string> folderHashes;
-  std::map<std::string, std::vector<SortType> >::const_iterator fcIter = folderContents.begin();
-  while (fcIter != folderContents.end())
+  // Group messages by folder in one pass. Messages without folder get "" as
+  // folder name, and their entries go into index.html.
+  std::map<std::string, IndexFolder> folders;
+  const std::string noFolder;
+  for (const IndexEntry& item: sortedList)
   {
-    folderHashes[fcIter->first] = SHA256::computeFromBuffer((uint8_t*) fcIter->first.c_str(), fcIter->first.length()*8).toHexString();
-    ++fcIter;
+    const std::string& folderName = fm.hasEntry(*item.digest) ? fm.getFolderName(*item.digest) : noFolder;
+    folders[folderName].entries.push_back(&item);
+  }
+
+  // The folder list only differs in the marker of the current folder, so
+  // every entry of the list is rendered just once with either marker.
+  std::size_t folderListLength = 0;
+  for (auto& [name, folder]: folders)
+  {
+    if (name.empty())
+    {
+      folder.fileName = "index.html";
+      continue;
+    }
+    folder.fileName = "folder_" + pmdb::sha256::computeFromString(name).toHexString() + ".html";
+    folderEntry.addReplacement("folder_link", folder.fileName, false);
+    folderEntry.addReplacement("folder_name", name, true);
+    folderEntry.addReplacement("marker", otherFolderMarker, false);
+    folderEntry.render(folder.listEntry);
+    folderEntry.addReplacement("marker", currentFolderMarker, false);
+    folderEntry.render(folder.currentListEntry);
+    folderListLength += std::max(folder.listEntry.size(), folder.currentListEntry.size());
   }
 
   index.addReplacement("doctype", doctype(standard), false);
-  fcIter = folderContents.begin();
-  while (fcIter != folderContents.end())
-  {
-    std::string entries;
-    std::vector<SortType>::const_iterator vecIter = fcIter->second.begin();
-    while (vecIter != fcIter->second.end())
-    {
-      const PrivateMessage& currMessage = getMessage(vecIter->md);
-      entry.addReplacement("date",       vecIter->datestamp, true);
-      entry.addReplacement("pm_url",     vecIter->md.toHexString() + ".html", false);
-      entry.addReplacement("title",      currMessage.getTitle(), true);
-      entry.addReplacement("fromuserid", intToString(currMessage.getFromUserID()), true);
-      entry.addReplacement("fromuser",   currMessage.getFromUser(), true);
-      entries += entry.show();
-      ++vecIter;
+  std::string entries;
+  std::string folderEntries;
+  folderEntries.reserve(folderListLength);
+  std::string indexText;
+  for (const auto& [name, folder]: folders)
+  {
+    entries.clear();
+    for (const IndexEntry* item: folder.entries)
+    {
+      entry.addReplacement("date",       item->datestamp, true);
+      entry.addReplacement("pm_url",     item->hexDigest + ".html", false);
+      entry.addReplacement("title",      item->pm->getTitle(), true);
+      entry.addReplacement("fromuserid", intToString(item->pm->getFromUserID()), true);
+      entry.addReplacement("fromuser",   item->pm->getFromUser(), true);
+      entry.render(entries);
     }
     index.addReplacement("entries", entries, false);
-    const auto codeOfFolderList = generateFolderList(folderList, folderEntry, folderContents, folderHashes, fcIter->first);
-    index.addReplacement("folders", codeOfFolderList, false);
-    const std::string indexText = index.show();
-    std::ofstream indexFile;
-    std::string fileName = directory;
-    if (fcIter->first != "")
-      fileName = fileName + "folder_" + folderHashes[fcIter->first] + ".html";
-    else
-      fileName = fileName + "index.html";
 
-    indexFile.open(fileName, std::ios_base::out | std::ios_base::binary);
+    folderEntries.clear();
+    for (const auto& [otherName, other]: folders)
+    {
+      if (!otherName.empty())
+        folderEntries.append(&other == &folder ? other.currentListEntry : other.listEntry);
+    }
+    folderList.addReplacement("folder_entries", folderEntries, false);
+    index.addReplacement("folders", folderList.show(), false);
+
+    indexText.clear();
+    index.render(indexText);
+    std::ofstream indexFile;
+    indexFile.open(directory + folder.fileName, std::ios_base::out | std::ios_base::binary);
     if (!indexFile)
     {
       return false;
@@ -472,36 +1309,106 @@ bool MessageDatabase::saveIndexFiles(const std::string& directory, MsgTemplate i
     {
       return false;
     }
-    ++fcIter;
   }
   return true;
 }
 
 
-std::map<md_date, std::vector<md_date> > MessageDatabase::getTextSubsets() const
+std::map<md_date, std::vector<md_date> > MessageDatabase::getTextSubsets(const unsigned int jobs, const pmdb::containment::ProgressFunction& progress) const
 {
+  std::vector<Iterator> messages;
+  std::vector<std::string_view> texts;
+  messages.reserve(m_Messages.size());
+  texts.reserve(m_Messages.size());
+  for (Iterator iter = m_Messages.begin(); iter != m_Messages.end(); ++iter)
+  {
+    messages.push_back(iter);
+    texts.push_back(iter->second.getMessage());
+  }
+
+  const auto contained = pmdb::containment::findContainedTexts(texts, jobs, progress);
   std::map<md_date, std::vector<md_date> > result;
-  Iterator iter = m_Messages.begin();
-  while (iter != m_Messages.end())
+  for (std::size_t i = 0; i < contained.size(); ++i)
+  {
+    if (contained[i].empty())
+      continue;
+    std::vector<md_date>& subsets = result[md_date(messages[i]->first, messages[i]->second.getDatestamp())];
+    subsets.reserve(contained[i].size());
+    for (const std::size_t idx: contained[i])
+    {
+      subsets.push_back(md_date(messages[idx]->first, messages[idx]->second.getDatestamp()));
+    }
+  }
+  return result;
+}
+
+bool MessageDatabase::normaliseMessages(std::size_t& changed, FolderMap& fm, const unsigned int jobs)
+{
+  changed = 0;
+  std::vector<MessageStore::value_type> entries = m_Messages.extract();
+  // 0 = unchanged, 1 = normalised, 2 = text could not be read
+  std::vector<uint8_t> status(entries.size(), 0);
+  pmdb::parallel::forEachIndex(entries.size(), jobs,
+      [&entries, &status](const std::size_t idx)
+      {
+        PrivateMessage& pm = entries[idx].second;
+        try
+        {
+          if (pm.normalise())
+          {
+            pm.getHash();
+            status[idx] = 1;
+          }
+        }
+        catch (const std::runtime_error&)
+        {
+          status[idx] = 2;
+        }
+        return true;
+      });
+
+  bool success = true;
+  m_Messages.reserve(entries.size());
+  for (std::size_t idx = 0; idx < entries.size(); ++idx)
   {
-    Iterator innerIter = m_Messages.begin();
-    while (innerIter != m_Messages.end())
+    PrivateMessage& pm = entries[idx].second;
+    if (status[idx] == 1)
     {
-      if (iter != innerIter)
+      ++changed;
+      // The message is not stored under its old hash anymore, neither in
+      // the folder map nor in any directory.
+      const SHA256::MessageDigest& oldDigest = entries[idx].first;
+      if (fm.hasEntry(oldDigest))
       {
-        if (iter->second.getMessage().find(innerIter->second.getMessage())!=std::string::npos)
+        const SHA256::MessageDigest newDigest = pm.getHash();
+        if (!fm.hasEntry(newDigest))
         {
-          result[md_date(iter->first, iter->second.getDatestamp())].push_back(md_date(innerIter->first, innerIter->second.getDatestamp()));
+          fm.add(newDigest, fm.getFolderName(oldDigest));
         }
+        fm.remove(oldDigest);
       }
-      ++innerIter;
+      for (auto& directory: m_KnownFiles)
+      {
+        directory.second.digests.erase(oldDigest);
+      }
+      m_Replaced.insert(oldDigest);
+      addMessage(std::move(pm));
+      continue;
     }
-    ++iter;
+    if (status[idx] == 2)
+    {
+      std::cerr << "Error: Could not read the text of message "
+                << entries[idx].first.toHexString() << " for normalisation!\n";
+      success = false;
+    }
+    m_Messages.insert(entries[idx].first, std::move(pm));
   }
-  return result;
+  return success;
 }
 
 void MessageDatabase::clear()
 {
   m_Messages.clear();
+  m_KnownFiles.clear();
+  m_Replaced.clear();
 }
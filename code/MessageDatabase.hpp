@@ -1,7 +1,7 @@
 /*
  -------------------------------------------------------------------------------
     This file is part of the Private Message Database.
-    Copyright (C) 2012, 2013, 2014, 2015, 2025  Dirk Stolle
+    Copyright (C) 2012, 2013, 2014, 2015, 2025, 2026  Dirk Stolle
 
     This program is free software: you can redistribute it and/or modify
     it under the terms of the GNU General Public License as published by
@@ -21,16 +21,24 @@
 #ifndef MESSAGEDATABASE_HPP
 #define MESSAGEDATABASE_HPP
 
+#include <functional>
 #include <map>
+#include <set>
 #include <vector>
 #include "HTMLStandard.hpp"
+#include "LoadMode.hpp"
+#include "MessageStore.hpp"
 #include "PrivateMessage.hpp"
+#include "SaveMode.hpp"
+#include "Storage.hpp"
 #include "MsgTemplate.hpp"
 #include "FolderMap.hpp"
 #include "SortType.hpp"
+#include "TextContainment.hpp"
+#include "Verification.hpp"
 
-//forward declaration of XMLNode
-class XMLNode;
+//forward declaration of XMLReader
+class XMLReader;
 
 class MessageDatabase
 {
@@ -48,6 +56,16 @@ class MessageDatabase
     bool addMessage(PrivateMessage& pm);
 
 
+    /** \brief Moves a message into the database.
+     *
+     * \param pm the message that shall be added
+     * \return Returns true, if the message was added.
+     *         If the message already exists in the database, the function will
+     *         return false and leave both the DB and pm unchanged.
+     */
+    bool addMessage(PrivateMessage&& pm);
+
+
     /** \brief Returns the number of messages that are in the database.
      *
      * \return Returns the number of messages that are in the database.
@@ -79,14 +97,26 @@ class MessageDatabase
      * \param readPMs  will hold the number of PMs that were read from the file
      * \param newPMs   will hold the number of new PMs that were stored in the DB
      * \param fm       reference to the folder map that will save folder information
+     * \param jobs     the maximum number of threads to use
      * \return Returns true in case of success, false in case of error.
      *         In either case, readPMs will hold the number of messages that
      *         were successfully read from the file.
+     * \remarks The file is read as a stream, and every message is added to
+     *          the database as soon as its element is complete. So memory use
+     *          does not depend on the size of the file, but messages that were
+     *          read before an error occurred remain in the database.
+     *          If more than one job is requested, the file is parsed on the
+     *          calling thread, while jobs - 2 (but at least one) other threads
+     *          normalise and hash the messages and one more thread inserts
+     *          them into the database in the order of the file. If the
+     *          system cannot start these threads, fewer workers or only the
+     *          calling thread are used.
      */
-    bool importFromFile(const std::string& fileName, uint32_t& readPMs, uint32_t& newPMs, FolderMap& fm);
+    bool importFromFile(const std::string& fileName, uint32_t& readPMs, uint32_t& newPMs, FolderMap& fm, const unsigned int jobs = 1);
 
 
-    typedef std::map<SHA256::MessageDigest, PrivateMessage>::const_iterator Iterator;
+    /// iterator that visits the messages in ascending order of their digests
+    typedef MessageStore::const_iterator Iterator;
 
 
     /** \brief return iterator to the start of the DB's element list */
@@ -100,9 +130,24 @@ class MessageDatabase
      *
      * \param directory directory where the messages shall be saved
      * \param compression  The type of compression to use when saving the PMs.
+     * \param jobs      number of threads to use for saving the messages
+     * \param mode      If set to SaveMode::Incremental, only messages which are
+     *                  not known to exist in the directory with the given
+     *                  compression are written. Messages are known to exist,
+     *                  if they have been loaded from or saved to the directory
+     *                  before, or if they are in the directory's message pack.
+     *                  SaveMode::Full writes all messages.
+     * \param storage   Storage::Directory saves one file per message,
+     *                  Storage::Pack saves the messages in a message pack.
      * \return Returns true in case of success, or false otherwise.
+     * \remarks The function returns false as soon as any message could not be
+     *          saved, no matter how many threads are used.
+     *          After a successful save the directory is converted to the
+     *          requested storage: a pack is removed once all of its messages
+     *          have been saved as single files, and single files which have
+     *          been loaded are removed once they have been saved to the pack.
      */
-    bool saveMessages(const std::string& directory, const Compression compression) const;
+    bool saveMessages(const std::string& directory, const Compression compression, const unsigned int jobs = 1, const SaveMode mode = SaveMode::Full, const Storage storage = Storage::Directory);
 
 
     /** \brief Tries to load all messages in the given directory into the database.
@@ -113,9 +158,28 @@ class MessageDatabase
      * \param compression  The type of (de-)compression to use when loading the
      *                     PMs from the directory. Currently, zlib or none are
      *                     supported.
+     * \param jobs      number of threads to use for loading the messages
+     * \param verification  Verification::Full checks every message against
+     *                  the hash in its file name, Verification::Sample checks
+     *                  only every pmdb::verification::sampleInterval-th
+     *                  message, and Verification::None trusts the file names.
+     * \param loadMode  LoadMode::Headers releases the text of every message
+     *                  after it has been loaded, so that only the other data
+     *                  stays in memory. The text is read again from the file
+     *                  when it is needed, e.g. for HTML files or saving.
      * \return Returns true in case of success, or false otherwise.
+     * \remarks If an error occurs, all messages from files which come before
+     *          the faulty file in the directory listing have been added to the
+     *          database, just like when only one thread is used.
+     *          Files which have been checked successfully are recorded in the
+     *          verification cache of the directory (see VerificationCache.hpp)
+     *          and are not hashed again as long as their size and modification
+     *          time do not change.
+     *          If the directory contains a message pack, the messages in the
+     *          pack are loaded, too. The compression of the pack is taken from
+     *          the pack itself and not from the compression parameter.
      */
-    bool loadMessages(const std::string& directory, uint32_t& readPMs, uint32_t& newPMs, const Compression compression);
+    bool loadMessages(const std::string& directory, uint32_t& readPMs, uint32_t& newPMs, const Compression compression, const unsigned int jobs = 1, const Verification verification = Verification::Full, const LoadMode loadMode = LoadMode::Full);
 
 
     /** \brief Creates index files (HTML) for all message folders.
@@ -126,49 +190,169 @@ class MessageDatabase
      * \param folderList  template for the folder list
      * \param folderEntry template for a folder entry in the list
      * \param fm          the current folder map
+     * \param standard    the HTML standard to use for the files
      * \return Returns true, if file was created successfully.
+     * \remarks The messages are sorted once and grouped by folder in a single
+     *          pass, and every entry of the folder list is rendered only once
+     *          per marker. So the time is linear in the number of messages,
+     *          apart from sorting.
      */
     bool saveIndexFiles(const std::string& directory, MsgTemplate index, MsgTemplate entry, MsgTemplate folderList, MsgTemplate folderEntry, const FolderMap& fm, const HTMLStandard standard) const;
 
 
     /** \brief finds messages whose texts "overlap"
      *
+     * \param jobs      the maximum number of threads to use for the search
+     * \param progress  function that is notified about the progress of the
+     *                  search (may be empty)
      * \return Returns a map where a hash-datestamp struct for a message is
      *         mapped to a vector of hash-datestamp structs of messages whose
      *         texts are contained in the key message.
+     * \remarks Messages are not compared pairwise. Instead, an index of text
+     *          fingerprints is used to find candidates, see
+     *          pmdb::containment::findContainedTexts() for details.
+     */
+    std::map<md_date, std::vector<md_date> > getTextSubsets(const unsigned int jobs = 1, const pmdb::containment::ProgressFunction& progress = nullptr) const;
+
+
+    /** \brief Normalises the line breaks of all messages in the database.
+     *
+     * \param changed  will hold the number of messages whose text was changed
+     * \param fm       the folder map; entries of changed messages are moved to
+     *                 their new hash
+     * \param jobs     the maximum number of threads to use
+     * \return Returns true in case of success, false in case of error.
+     * \remarks Messages whose text changes get a new hash, and a changed
+     *          message that becomes equal to another message is only kept
+     *          once. Texts that are not in memory are read for the check, and
+     *          changed texts stay in memory afterwards. If a text cannot be
+     *          read, the message is kept unchanged and the function returns
+     *          false after all other messages have been normalised.
+     *          The files and pack records of the old hashes are removed by
+     *          the next call of saveMessages() for their directory.
      */
-    std::map<md_date, std::vector<md_date> > getTextSubsets() const;
+    bool normaliseMessages(std::size_t& changed, FolderMap& fm, const unsigned int jobs);
 
 
     /** \brief Removes all messages from the database.
+     *
+     * \remarks This also forgets which messages are known to exist in the
+     *          directories they were loaded from or saved to, and which
+     *          messages have been replaced by normaliseMessages().
      */
     void clear();
   private:
-    /** \brief Processes a <folder> XML node.
+    /** type of function that gets every message that was read from an XML
+        file, together with the name of its folder (or empty for no folder) */
+    typedef std::function<void(PrivateMessage&& pm, const std::string& folder)> MessageSink;
+
+
+    /** \brief Reads all messages from an XML file.
      *
-     * \param node    the XML node
+     * \param fileName path to the XML file
+     * \param readPMs  will hold the number of PMs that were read from the file
+     * \param store    function that gets every message that was read
+     * \return Returns true in case of success, false in case of error.
+     */
+    bool readXMLFile(const std::string& fileName, uint32_t& readPMs, const MessageSink& store);
+
+
+    /** \brief Processes a <folder> XML element.
+     *
+     * \param reader  XML reader that is positioned at the start of the element;
+     *                it will be positioned at the end of the element afterwards
      * \param readPMs will hold the number of PMs that were read from the node
-     * \param newPMs  will hold the number of new PMs that were stored in the DB
-     * \param fm      FolderMap that will be used to store folder information
+     * \param store   function that gets every message that was read
      * \return Returns true, if the node could be processed successfully.
      *         Returns false, if an error occurred.
      */
-    bool processFolderNode(const XMLNode& node, uint32_t& readPMs, uint32_t& newPMs, FolderMap& fm);
+    bool processFolderNode(XMLReader& reader, uint32_t& readPMs, const MessageSink& store);
 
 
-    /** \brief Processes a <privatemessage> XML node.
+    /** \brief Processes a <privatemessage> XML element.
      *
-     * \param node    the XML node
+     * \param reader  XML reader that is positioned at the start of the element;
+     *                it will be positioned at the end of the element afterwards
      * \param readPMs will hold the number of PMs that were read from the node
-     * \param newPMs  will hold the number of new PMs that were stored in the DB
      * \param folder  name of the containing folder (or empty for no folder)
-     * \param fm      FolderMap that will be used to store folder information
+     * \param store   function that gets the message, if it is valid
      * \return Returns true, if the node was processed successfully.
      *         Returns false, if an error occurred.
      */
-    bool processPrivateMessageNode(const XMLNode& node, uint32_t& readPMs, uint32_t& newPMs, const std::string& folder, FolderMap& fm);
+    bool processPrivateMessageNode(XMLReader& reader, uint32_t& readPMs, const std::string& folder, const MessageSink& store);
+
+    /** \brief Saves messages as single files into a directory.
+     *
+     * \param realDirectory directory where the messages shall be saved,
+     *                      including trailing slash
+     * \param compression   The type of compression to use when saving the PMs.
+     * \param jobs          number of threads to use for saving the messages
+     * \param mode          whether all messages or only unknown messages are saved
+     * \return Returns true in case of success, or false otherwise.
+     */
+    bool saveFiles(const std::string& realDirectory, const Compression compression, const unsigned int jobs, const SaveMode mode);
+
+
+    /** \brief Checks whether a message has been replaced by its normalised
+     *         version and is not in the database anymore.
+     *
+     * \param digest  hash of the message
+     * \return Returns true, if the message has been replaced.
+     */
+    bool isReplaced(const SHA256::MessageDigest& digest) const;
+
+
+    /** \brief Removes the files of replaced messages from a directory.
+     *
+     * \param realDirectory directory of the message files, including
+     *                      trailing slash
+     */
+    void removeReplacedFiles(const std::string& realDirectory) const;
+
+
+    /** \brief Saves messages to the message pack of a directory.
+     *
+     * \param realDirectory directory where the messages shall be saved,
+     *                      including trailing slash
+     * \param compression   The type of compression to use when saving the PMs.
+     * \param jobs          number of threads to use for compressing the messages
+     * \param mode          SaveMode::Incremental appends messages which are not
+     *                      in the pack yet, SaveMode::Full rewrites the pack.
+     * \return Returns true in case of success, or false otherwise.
+     * \remarks The pack is rewritten, too, if its compression differs from
+     *          the requested one. A rewritten pack still contains the records
+     *          of messages which are in the existing pack but not in the
+     *          database, e. g. because they were not loaded. Records of
+     *          replaced messages are dropped, which also forces a rewrite.
+     */
+    bool savePack(const std::string& realDirectory, const Compression compression, const unsigned int jobs, const SaveMode mode) const;
+
+
+    /** \brief Loads all messages from the message pack of a directory.
+     *
+     * \param realDirectory directory which contains the message pack,
+     *                      including trailing slash
+     * \param readPMs   will be increased by the number of PMs read from the pack
+     * \param newPMs    will be increased by the number of new PMs stored in the DB
+     * \param jobs      number of threads to use for loading the messages
+     * \param verification  which messages are checked against their digest
+     *                  in the index
+     * \param loadMode  whether the message texts are kept in memory
+     * \return Returns true in case of success, or false otherwise.
+     */
+    bool loadPack(const std::string& realDirectory, uint32_t& readPMs, uint32_t& newPMs, const unsigned int jobs, const Verification verification, const LoadMode loadMode);
+
+    MessageStore m_Messages; /**< store that holds the messages */
+
+    /// messages that are known to exist in a directory
+    struct KnownFiles
+    {
+      Compression compression; /**< compression of the message files */
+      std::set<SHA256::MessageDigest> digests; /**< digests of the messages */
+    };
 
-    std::map<SHA256::MessageDigest, PrivateMessage> m_Messages; /**< map that holds the messages */
+    std::map<std::string, KnownFiles> m_KnownFiles; /**< known messages per directory (with trailing slash) */
+    std::set<SHA256::MessageDigest> m_Replaced; /**< old hashes of messages changed by normaliseMessages() */
 }; // class
 
 #endif // MESSAGEDATABASE_HPP
@@ -0,0 +1,205 @@
+/*
+ -------------------------------------------------------------------------------
+    This file is part of the Private Message Database.
+    Copyright (C) 2026  Dirk Stolle
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ -------------------------------------------------------------------------------
+*/
+
+#include "MessagePack.hpp"
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include "../libstriezel/filesystem/directory.hpp"
+
+namespace pmdb::pack
+{
+
+namespace
+{
+
+/// magic bytes at the start of the pack file
+constexpr char packMagic[8] = { 'P', 'M', 'D', 'B', 'P', 'A', 'C', 'K' };
+
+/// magic bytes at the start of the index file
+constexpr char indexMagic[8] = { 'P', 'M', 'D', 'B', 'I', 'D', 'X', '\0' };
+
+/// current version of the pack and index format
+constexpr std::uint32_t formatVersion = 1;
+
+/// size of a single entry in the index file in bytes
+constexpr std::size_t entrySize = sizeof(SHA256::MessageDigest::hash) + sizeof(std::uint64_t) + sizeof(std::uint32_t);
+
+bool lessByDigest(const IndexEntry& a, const IndexEntry& b)
+{
+  return a.digest < b.digest;
+}
+
+} // anonymous namespace
+
+bool exists(const std::string& directory)
+{
+  std::error_code error;
+  return std::filesystem::is_regular_file(libstriezel::filesystem::slashify(directory) + packFileName, error);
+}
+
+bool writeHeader(std::ostream& stream, const Compression compression)
+{
+  const std::uint32_t compressionValue = (compression == Compression::zlib) ? 1 : 0;
+  stream.write(packMagic, sizeof(packMagic));
+  stream.write(reinterpret_cast<const char*>(&formatVersion), sizeof(formatVersion));
+  stream.write(reinterpret_cast<const char*>(&compressionValue), sizeof(compressionValue));
+  return stream.good();
+}
+
+bool readHeader(std::istream& stream, Compression& compression)
+{
+  char header[headerSize];
+  if (!stream.read(header, headerSize))
+  {
+    return false;
+  }
+  return readHeader(header, headerSize, compression);
+}
+
+bool readHeader(const char* data, const std::size_t size, Compression& compression)
+{
+  if ((data == nullptr) || (size < headerSize)
+      || (std::memcmp(data, packMagic, sizeof(packMagic)) != 0))
+  {
+    return false;
+  }
+  std::uint32_t version = 0;
+  std::uint32_t compressionValue = 0;
+  std::memcpy(&version, data + sizeof(packMagic), sizeof(version));
+  std::memcpy(&compressionValue, data + sizeof(packMagic) + sizeof(version), sizeof(compressionValue));
+  if ((version != formatVersion) || (compressionValue > 1))
+  {
+    return false;
+  }
+  compression = (compressionValue == 1) ? Compression::zlib : Compression::none;
+  return true;
+}
+
+bool readIndex(const std::string& directory, std::vector<IndexEntry>& entries)
+{
+  entries.clear();
+  std::ifstream stream(libstriezel::filesystem::slashify(directory) + indexFileName, std::ios_base::in | std::ios_base::binary);
+  if (!stream)
+  {
+    return false;
+  }
+  char magic[sizeof(indexMagic)];
+  std::uint32_t version = 0;
+  std::uint64_t count = 0;
+  stream.read(magic, sizeof(magic));
+  stream.read(reinterpret_cast<char*>(&version), sizeof(version));
+  stream.read(reinterpret_cast<char*>(&count), sizeof(count));
+  if (!stream.good() || (std::memcmp(magic, indexMagic, sizeof(indexMagic)) != 0)
+      || (version != formatVersion))
+  {
+    return false;
+  }
+
+  std::string buffer(entrySize, '\0');
+  for (std::uint64_t i = 0; i < count; ++i)
+  {
+    if (!stream.read(buffer.data(), entrySize))
+    {
+      entries.clear();
+      return false;
+    }
+    IndexEntry entry;
+    const char* ptr = buffer.c_str();
+    std::memcpy(entry.digest.hash, ptr, sizeof(entry.digest.hash));
+    ptr += sizeof(entry.digest.hash);
+    std::memcpy(&entry.offset, ptr, sizeof(entry.offset));
+    ptr += sizeof(entry.offset);
+    std::memcpy(&entry.size, ptr, sizeof(entry.size));
+    // Entries have to be sorted and unique, or lookups will fail.
+    if (!entries.empty() && !(entries.back().digest < entry.digest))
+    {
+      entries.clear();
+      return false;
+    }
+    entries.push_back(entry);
+  }
+  return true;
+}
+
+bool writeIndex(const std::string& directory, const std::vector<IndexEntry>& entries)
+{
+  return prepareIndex(directory, entries) && commitIndex(directory);
+}
+
+bool prepareIndex(const std::string& directory, const std::vector<IndexEntry>& entries)
+{
+  const std::string tempPath = libstriezel::filesystem::slashify(directory) + indexFileName + ".tmp";
+  std::ofstream stream(tempPath, std::ios_base::out | std::ios_base::binary | std::ios_base::trunc);
+  if (!stream)
+  {
+    return false;
+  }
+  const std::uint64_t count = entries.size();
+  stream.write(indexMagic, sizeof(indexMagic));
+  stream.write(reinterpret_cast<const char*>(&formatVersion), sizeof(formatVersion));
+  stream.write(reinterpret_cast<const char*>(&count), sizeof(count));
+  for (const auto& entry: entries)
+  {
+    stream.write(reinterpret_cast<const char*>(entry.digest.hash), sizeof(entry.digest.hash));
+    stream.write(reinterpret_cast<const char*>(&entry.offset), sizeof(entry.offset));
+    stream.write(reinterpret_cast<const char*>(&entry.size), sizeof(entry.size));
+  }
+  stream.close();
+  if (!stream.good())
+  {
+    discardIndex(directory);
+    return false;
+  }
+  return true;
+}
+
+bool commitIndex(const std::string& directory)
+{
+  const std::string indexPath = libstriezel::filesystem::slashify(directory) + indexFileName;
+  std::error_code error;
+  std::filesystem::rename(indexPath + ".tmp", indexPath, error);
+  return !error;
+}
+
+void discardIndex(const std::string& directory)
+{
+  std::error_code error;
+  std::filesystem::remove(libstriezel::filesystem::slashify(directory) + indexFileName + ".tmp", error);
+}
+
+bool contains(const std::vector<IndexEntry>& entries, const SHA256::MessageDigest& digest)
+{
+  IndexEntry key;
+  key.digest = digest;
+  return std::binary_search(entries.begin(), entries.end(), key, lessByDigest);
+}
+
+bool remove(const std::string& directory)
+{
+  const std::string realDirectory = libstriezel::filesystem::slashify(directory);
+  std::error_code error;
+  const bool packRemoved = std::filesystem::remove(realDirectory + packFileName, error) && !error;
+  const bool indexRemoved = std::filesystem::remove(realDirectory + indexFileName, error) && !error;
+  return packRemoved && indexRemoved;
+}
+
+} // namespace
@@ -0,0 +1,169 @@
+/*
+ -------------------------------------------------------------------------------
+    This file is part of the Private Message Database.
+    Copyright (C) 2026  Dirk Stolle
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ -------------------------------------------------------------------------------
+*/
+
+#ifndef PMDB_MESSAGEPACK_HPP
+#define PMDB_MESSAGEPACK_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "Compression.hpp"
+#include "../libstriezel/hash/sha256/sha256.hpp"
+
+/* A message pack stores all messages of a directory in a single file instead
+   of one file per message. It consists of two files:
+
+   - messages.pack: a header (magic bytes, format version, compression) which
+     is followed by the records of all messages. Each record contains exactly
+     the bytes that PrivateMessage::saveToFile() would write for the message.
+     New records are only ever appended to the end of the file.
+   - messages.idx: a header (magic bytes, format version) which is followed
+     by one entry per message, sorted by digest. An entry contains the digest
+     of the message and the offset and size of its record in the pack file.
+*/
+
+namespace pmdb::pack
+{
+
+/// name of the pack file within a message directory
+const std::string packFileName = "messages.pack";
+
+/// name of the index file within a message directory
+const std::string indexFileName = "messages.idx";
+
+/// size of the pack file header in bytes
+constexpr std::uint64_t headerSize = 16;
+
+/// entry of the pack index
+struct IndexEntry
+{
+  SHA256::MessageDigest digest; /**< digest of the message */
+  std::uint64_t offset;         /**< offset of the record in the pack file */
+  std::uint32_t size;           /**< size of the record in bytes */
+};
+
+
+/** \brief Checks whether a directory contains a message pack.
+ *
+ * \param directory  the directory
+ * \return Returns true, if the directory contains a pack file.
+ */
+bool exists(const std::string& directory);
+
+
+/** \brief Writes the header of a pack file.
+ *
+ * \param stream       the stream to write to
+ * \param compression  compression of the records in the pack
+ * \return Returns true in case of success, or false if an error occurred.
+ */
+bool writeHeader(std::ostream& stream, const Compression compression);
+
+
+/** \brief Reads the header of a pack file.
+ *
+ * \param stream       the stream to read from
+ * \param compression  will hold the compression of the records in the pack
+ * \return Returns true in case of success, or false if the header could not
+ *         be read or is not a valid pack header.
+ */
+bool readHeader(std::istream& stream, Compression& compression);
+
+
+/** \brief Reads the header of a pack file from memory.
+ *
+ * \param data         pointer to the start of the pack file
+ * \param size         size of the data in bytes
+ * \param compression  will hold the compression of the records in the pack
+ * \return Returns true in case of success, or false if the header could not
+ *         be read or is not a valid pack header.
+ */
+bool readHeader(const char* data, const std::size_t size, Compression& compression);
+
+
+/** \brief Reads the pack index of a directory.
+ *
+ * \param directory  the directory that contains the message pack
+ * \param entries    will hold the index entries, sorted by digest
+ * \return Returns true in case of success, or false if an error occurred.
+ */
+bool readIndex(const std::string& directory, std::vector<IndexEntry>& entries);
+
+
+/** \brief Writes the pack index of a directory.
+ *
+ * \param directory  the directory that contains the message pack
+ * \param entries    the index entries, sorted by digest
+ * \return Returns true in case of success, or false if an error occurred.
+ * \remarks The index is written to a temporary file first, which then
+ *          replaces the existing index.
+ */
+bool writeIndex(const std::string& directory, const std::vector<IndexEntry>& entries);
+
+
+/** \brief Writes the pack index of a directory to a temporary file, without
+ *         replacing the existing index yet.
+ *
+ * \param directory  the directory that contains the message pack
+ * \param entries    the index entries, sorted by digest
+ * \return Returns true in case of success, or false if an error occurred.
+ * \remarks commitIndex() replaces the existing index with the temporary
+ *          file, discardIndex() removes the temporary file.
+ */
+bool prepareIndex(const std::string& directory, const std::vector<IndexEntry>& entries);
+
+
+/** \brief Replaces the pack index of a directory with the index written by
+ *         prepareIndex().
+ *
+ * \param directory  the directory that contains the message pack
+ * \return Returns true in case of success, or false if an error occurred.
+ */
+bool commitIndex(const std::string& directory);
+
+
+/** \brief Removes the temporary index written by prepareIndex(), if any.
+ *
+ * \param directory  the directory that contains the message pack
+ */
+void discardIndex(const std::string& directory);
+
+
+/** \brief Finds the index entry for a digest.
+ *
+ * \param entries  index entries, sorted by digest
+ * \param digest   the digest to search for
+ * \return Returns true, if there is an entry for the digest.
+ */
+bool contains(const std::vector<IndexEntry>& entries, const SHA256::MessageDigest& digest);
+
+
+/** \brief Deletes the pack file and the index of a directory.
+ *
+ * \param directory  the directory that contains the message pack
+ * \return Returns true, if both files were deleted.
+ */
+bool remove(const std::string& directory);
+
+} // namespace
+
+#endif // PMDB_MESSAGEPACK_HPP
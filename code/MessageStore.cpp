@@ -0,0 +1,233 @@
+/*
+ -------------------------------------------------------------------------------
+    This file is part of the Private Message Database.
+    Copyright (C) 2026  Dirk Stolle
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ -------------------------------------------------------------------------------
+*/
+
+#include "MessageStore.hpp"
+#include <algorithm>
+
+MessageStore::const_iterator::const_iterator()
+: m_Entries(nullptr),
+  m_Position(nullptr)
+{
+}
+
+MessageStore::const_iterator::const_iterator(const value_type* entries, const std::uint32_t* position)
+: m_Entries(entries),
+  m_Position(position)
+{
+}
+
+MessageStore::const_iterator::reference MessageStore::const_iterator::operator*() const
+{
+  return m_Entries[*m_Position];
+}
+
+MessageStore::const_iterator::pointer MessageStore::const_iterator::operator->() const
+{
+  return &m_Entries[*m_Position];
+}
+
+MessageStore::const_iterator& MessageStore::const_iterator::operator++()
+{
+  ++m_Position;
+  return *this;
+}
+
+MessageStore::const_iterator MessageStore::const_iterator::operator++(int)
+{
+  const_iterator previous(*this);
+  ++m_Position;
+  return previous;
+}
+
+bool MessageStore::const_iterator::operator==(const const_iterator& other) const
+{
+  return m_Position == other.m_Position;
+}
+
+bool MessageStore::const_iterator::operator!=(const const_iterator& other) const
+{
+  return m_Position != other.m_Position;
+}
+
+
+MessageStore::MessageStore()
+: m_Entries(std::vector<value_type>()),
+  m_Slots(std::vector<Slot>()),
+  m_OrderMutex(),
+  m_Order(std::vector<std::uint32_t>())
+{
+}
+
+std::size_t MessageStore::size() const
+{
+  return m_Entries.size();
+}
+
+bool MessageStore::empty() const
+{
+  return m_Entries.empty();
+}
+
+std::uint64_t MessageStore::prefixOf(const SHA256::MessageDigest& digest)
+{
+  // Digests are uniformly distributed, so the bytes can be used as they are.
+  return (static_cast<std::uint64_t>(digest.hash[0]) << 32) | digest.hash[1];
+}
+
+std::size_t MessageStore::findSlot(const SHA256::MessageDigest& digest, const std::uint64_t prefix) const
+{
+  const std::size_t mask = m_Slots.size() - 1;
+  std::size_t idx = static_cast<std::size_t>(prefix) & mask;
+  while (m_Slots[idx].position != 0)
+  {
+    if ((m_Slots[idx].prefix == prefix) && (m_Entries[m_Slots[idx].position - 1].first == digest))
+    {
+      return idx;
+    }
+    idx = (idx + 1) & mask;
+  }
+  return idx;
+}
+
+void MessageStore::rehash(const std::size_t slotCount)
+{
+  m_Slots.assign(slotCount, Slot{ 0, 0 });
+  const std::size_t mask = slotCount - 1;
+  for (std::size_t i = 0; i < m_Entries.size(); ++i)
+  {
+    const std::uint64_t prefix = prefixOf(m_Entries[i].first);
+    std::size_t idx = static_cast<std::size_t>(prefix) & mask;
+    while (m_Slots[idx].position != 0)
+    {
+      idx = (idx + 1) & mask;
+    }
+    m_Slots[idx] = Slot{ prefix, static_cast<std::uint32_t>(i + 1) };
+  }
+}
+
+void MessageStore::reserve(const std::size_t count)
+{
+  m_Entries.reserve(count);
+  // Keep the load factor at or below one half, so that probe sequences stay short.
+  std::size_t slotCount = 16;
+  while (slotCount < 2 * count)
+  {
+    slotCount *= 2;
+  }
+  if (slotCount > m_Slots.size())
+  {
+    rehash(slotCount);
+  }
+}
+
+bool MessageStore::insert(const SHA256::MessageDigest& digest, const PrivateMessage& pm)
+{
+  return emplace(digest, pm);
+}
+
+bool MessageStore::insert(const SHA256::MessageDigest& digest, PrivateMessage&& pm)
+{
+  return emplace(digest, std::move(pm));
+}
+
+template<typename Message>
+bool MessageStore::emplace(const SHA256::MessageDigest& digest, Message&& pm)
+{
+  if (2 * (m_Entries.size() + 1) > m_Slots.size())
+  {
+    rehash(std::max<std::size_t>(16, 2 * m_Slots.size()));
+  }
+  const std::uint64_t prefix = prefixOf(digest);
+  const std::size_t idx = findSlot(digest, prefix);
+  if (m_Slots[idx].position != 0)
+  {
+    return false;
+  }
+  m_Entries.emplace_back(digest, std::forward<Message>(pm));
+  m_Slots[idx] = Slot{ prefix, static_cast<std::uint32_t>(m_Entries.size()) };
+  return true;
+}
+
+const PrivateMessage* MessageStore::find(const SHA256::MessageDigest& digest) const
+{
+  if (m_Entries.empty())
+  {
+    return nullptr;
+  }
+  const std::size_t idx = findSlot(digest, prefixOf(digest));
+  if (m_Slots[idx].position == 0)
+  {
+    return nullptr;
+  }
+  return &m_Entries[m_Slots[idx].position - 1].second;
+}
+
+bool MessageStore::contains(const SHA256::MessageDigest& digest) const
+{
+  return find(digest) != nullptr;
+}
+
+void MessageStore::clear()
+{
+  m_Entries.clear();
+  m_Slots.clear();
+  std::lock_guard<std::mutex> lock(m_OrderMutex);
+  m_Order.clear();
+}
+
+std::vector<MessageStore::value_type> MessageStore::extract()
+{
+  std::vector<value_type> entries = std::move(m_Entries);
+  clear();
+  return entries;
+}
+
+void MessageStore::updateOrder() const
+{
+  std::lock_guard<std::mutex> lock(m_OrderMutex);
+  const std::size_t sorted = m_Order.size();
+  if (sorted == m_Entries.size())
+  {
+    return;
+  }
+  // Only the new entries are sorted, then both sorted ranges are merged.
+  for (std::size_t i = sorted; i < m_Entries.size(); ++i)
+  {
+    m_Order.push_back(static_cast<std::uint32_t>(i));
+  }
+  const auto less = [this](const std::uint32_t a, const std::uint32_t b)
+  {
+    return m_Entries[a].first < m_Entries[b].first;
+  };
+  std::sort(m_Order.begin() + sorted, m_Order.end(), less);
+  std::inplace_merge(m_Order.begin(), m_Order.begin() + sorted, m_Order.end(), less);
+}
+
+MessageStore::const_iterator MessageStore::begin() const
+{
+  updateOrder();
+  return const_iterator(m_Entries.data(), m_Order.data());
+}
+
+MessageStore::const_iterator MessageStore::end() const
+{
+  updateOrder();
+  return const_iterator(m_Entries.data(), m_Order.data() + m_Order.size());
+}
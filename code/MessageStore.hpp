@@ -0,0 +1,223 @@
+/*
+ -------------------------------------------------------------------------------
+    This file is part of the Private Message Database.
+    Copyright (C) 2026  Dirk Stolle
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ -------------------------------------------------------------------------------
+*/
+
+#ifndef PMDB_MESSAGESTORE_HPP
+#define PMDB_MESSAGESTORE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <mutex>
+#include <utility>
+#include <vector>
+#include "PrivateMessage.hpp"
+
+/** Container for the messages of the database, mapped by their digest.
+
+    The messages are stored in a contiguous vector in the order in which they
+    were added. Lookups go through an open-addressing hash table with linear
+    probing, which uses the leading eight bytes of the digest as hash value.
+    Iteration visits the messages sorted by digest, just like a std::map.
+*/
+class MessageStore
+{
+  public:
+    typedef std::pair<const SHA256::MessageDigest, PrivateMessage> value_type;
+
+    /// iterator that visits the messages in ascending order of their digests
+    class const_iterator
+    {
+      public:
+        typedef std::forward_iterator_tag iterator_category;
+        typedef MessageStore::value_type value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef const value_type* pointer;
+        typedef const value_type& reference;
+
+        const_iterator();
+
+        reference operator*() const;
+        pointer operator->() const;
+        const_iterator& operator++();
+        const_iterator operator++(int);
+        bool operator==(const const_iterator& other) const;
+        bool operator!=(const const_iterator& other) const;
+      private:
+        friend class MessageStore;
+
+        const_iterator(const value_type* entries, const std::uint32_t* position);
+
+        const value_type* m_Entries; /**< start of the stored entries */
+        const std::uint32_t* m_Position; /**< current position in the order */
+    }; // class
+
+
+    /** \brief Creates an empty store. */
+    MessageStore();
+
+    MessageStore(const MessageStore& other) = delete;
+    MessageStore& operator=(const MessageStore& other) = delete;
+
+
+    /** \brief Gets the number of messages in the store.
+     *
+     * \return Returns the number of messages in the store.
+     */
+    std::size_t size() const;
+
+
+    /** \brief Checks whether the store contains no messages.
+     *
+     * \return Returns true, if there are no messages in the store.
+     */
+    bool empty() const;
+
+
+    /** \brief Adds a message to the store, unless its digest already exists.
+     *
+     * \param digest  the digest of the message
+     * \param pm      the message
+     * \return Returns true, if the message was added. Returns false, if there
+     *         already is a message with the same digest.
+     * \remarks Adding a message invalidates all iterators.
+     */
+    bool insert(const SHA256::MessageDigest& digest, const PrivateMessage& pm);
+
+
+    /** \brief Moves a message into the store, unless its digest already exists.
+     *
+     * \param digest  the digest of the message, must not refer to pm
+     * \param pm      the message
+     * \return Returns true, if the message was moved into the store. Returns
+     *         false and leaves pm unchanged, if there already is a message
+     *         with the same digest.
+     * \remarks Adding a message invalidates all iterators.
+     */
+    bool insert(const SHA256::MessageDigest& digest, PrivateMessage&& pm);
+
+
+    /** \brief Finds the message with a given digest.
+     *
+     * \param digest  the digest of the message
+     * \return Returns a pointer to the message, if it exists.
+     *         Returns nullptr otherwise.
+     */
+    const PrivateMessage* find(const SHA256::MessageDigest& digest) const;
+
+
+    /** \brief Checks whether a message with a given digest exists.
+     *
+     * \param digest  the digest of the message
+     * \return Returns true, if there is a message with that digest.
+     */
+    bool contains(const SHA256::MessageDigest& digest) const;
+
+
+    /** \brief Prepares the store for a given number of messages, so that no
+     *         reallocation is needed until that number is reached.
+     *
+     * \param count  the expected number of messages
+     */
+    void reserve(const std::size_t count);
+
+
+    /** \brief Removes all messages from the store. */
+    void clear();
+
+
+    /** \brief Removes all messages from the store and hands them over.
+     *
+     * \return Returns the messages that were in the store, in the order in
+     *         which they were added.
+     */
+    std::vector<value_type> extract();
+
+
+    /** \brief Gets an iterator to the message with the lowest digest.
+     *
+     * \return Returns an iterator to the first message in digest order.
+     * \remarks The sorted order is updated lazily after messages have been
+     *          added. This may be done from several threads at once, but not
+     *          while messages are added.
+     */
+    const_iterator begin() const;
+
+
+    /** \brief Gets the iterator past the last message in digest order.
+     *
+     * \return Returns the end iterator.
+     */
+    const_iterator end() const;
+  private:
+    /// slot of the hash table
+    struct Slot
+    {
+      std::uint64_t prefix;   /**< leading eight bytes of the digest */
+      std::uint32_t position; /**< index of the entry plus one, zero for an empty slot */
+    };
+
+
+    /** \brief Gets the hash value of a digest.
+     *
+     * \param digest  the digest
+     * \return Returns the leading eight bytes of the digest.
+     */
+    static std::uint64_t prefixOf(const SHA256::MessageDigest& digest);
+
+
+    /** \brief Finds the slot of a digest.
+     *
+     * \param digest  the digest
+     * \param prefix  the hash value of the digest
+     * \return Returns the index of the slot that holds the digest, or the
+     *         index of the empty slot where it would be inserted.
+     */
+    std::size_t findSlot(const SHA256::MessageDigest& digest, const std::uint64_t prefix) const;
+
+
+    /** \brief Adds a message to the store, unless its digest already exists.
+     *
+     * \param digest  the digest of the message
+     * \param pm      the message, is only copied or moved if it is added
+     * \return Returns true, if the message was added.
+     */
+    template<typename Message>
+    bool emplace(const SHA256::MessageDigest& digest, Message&& pm);
+
+
+    /** \brief Rebuilds the hash table with a new number of slots.
+     *
+     * \param slotCount  the new number of slots, has to be a power of two and
+     *                   larger than the number of entries
+     */
+    void rehash(const std::size_t slotCount);
+
+
+    /** \brief Adds the entries which are not in the sorted order yet. */
+    void updateOrder() const;
+
+
+    std::vector<value_type> m_Entries; /**< the messages in insertion order */
+    std::vector<Slot> m_Slots; /**< hash table, size is zero or a power of two */
+    mutable std::mutex m_OrderMutex; /**< guards updates of m_Order */
+    mutable std::vector<std::uint32_t> m_Order; /**< entry indices, sorted by digest */
+}; // class
+
+#endif // PMDB_MESSAGESTORE_HPP
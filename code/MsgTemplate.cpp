@@ -1,7 +1,7 @@
 /*
  -------------------------------------------------------------------------------
     This file is part of the Private Message Database.
-    Copyright (C) 2012, 2013, 2015, 2017  Dirk Stolle
+    Copyright (C) 2012, 2013, 2015, 2017, 2026  Dirk Stolle
 
     This program is free software: you can redistribute it and/or modify
     it under the terms of the GNU General Public License as published by
@@ -20,16 +20,121 @@
 
 #include "MsgTemplate.hpp"
 #include <fstream>
-#include <cstring>
+#include <iterator>
+#include <string_view>
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+  #include <emmintrin.h>
+  #define PMDB_TEMPLATE_SSE2
+#endif
+
+namespace
+{
+
+/** \brief Finds the next character that may have to be escaped in a
+ * replacement.
+ *
+ * \param data      the replacement text
+ * \param start     position where the search starts
+ * \param length    length of the replacement text
+ * \param killHTML  whether the characters &, < and > have to be escaped, too
+ * \return Returns the position of the next brace (or &, <, > if killHTML is
+ *         set) at or after start. Returns length, if there is none.
+ */
+std::size_t findSpecialCharacter(const char* data, std::size_t start, const std::size_t length, const bool killHTML)
+{
+  #ifdef PMDB_TEMPLATE_SSE2
+  // Sixteen bytes are checked at once, because most replacements do not
+  // contain any of the characters.
+  const __m128i openBrace = _mm_set1_epi8('{');
+  const __m128i closeBrace = _mm_set1_epi8('}');
+  const __m128i ampersand = _mm_set1_epi8('&');
+  const __m128i lessThan = _mm_set1_epi8('<');
+  const __m128i greaterThan = _mm_set1_epi8('>');
+  while (start + 16 <= length)
+  {
+    const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + start));
+    __m128i found = _mm_or_si128(_mm_cmpeq_epi8(chunk, openBrace), _mm_cmpeq_epi8(chunk, closeBrace));
+    if (killHTML)
+    {
+      found = _mm_or_si128(found, _mm_cmpeq_epi8(chunk, ampersand));
+      found = _mm_or_si128(found, _mm_cmpeq_epi8(chunk, lessThan));
+      found = _mm_or_si128(found, _mm_cmpeq_epi8(chunk, greaterThan));
+    }
+    const unsigned int mask = static_cast<unsigned int>(_mm_movemask_epi8(found));
+    if (mask != 0)
+    {
+      std::size_t offset = 0;
+      while ((mask & (1u << offset)) == 0)
+        ++offset;
+      return start + offset;
+    }
+    start += 16;
+  }
+  #endif
+  for (; start < length; ++start)
+  {
+    switch (data[start])
+    {
+      case '{':
+      case '}':
+           return start;
+      case '&':
+      case '<':
+      case '>':
+           if (killHTML)
+             return start;
+           break;
+      default:
+           break;
+    }
+  }
+  return length;
+}
+
+/** \brief Gets the replacement for a character found by findSpecialCharacter().
+ *
+ * \param data      the replacement text
+ * \param pos       position of the character
+ * \param length    length of the replacement text
+ * \param killHTML  whether the characters &, < and > have to be escaped, too
+ * \return Returns the escape sequence for the character. Returns the
+ *         character itself, if it does not need to be escaped, i.e. a brace
+ *         which is not part of "{.." or "..}".
+ */
+std::string_view escapeSequence(const char* data, const std::size_t pos, const std::size_t length, const bool killHTML)
+{
+  switch (data[pos])
+  {
+    case '&':
+         return killHTML ? "&amp;" : "&";
+    case '<':
+         return killHTML ? "&lt;" : "<";
+    case '>':
+         return killHTML ? "&gt;" : ">";
+    case '{':
+         if ((pos + 2 < length) && (data[pos + 1] == '.') && (data[pos + 2] == '.'))
+           return "&#x7B;";
+         return "{";
+    case '}':
+         if ((pos >= 2) && (data[pos - 1] == '.') && (data[pos - 2] == '.'))
+           return "&#x7D;";
+         return "}";
+    default:
+         return std::string_view(data + pos, 1);
+  }
+}
+
+} // namespace
 
 MsgTemplate::MsgTemplate()
-: m_Tags(std::map<std::string, std::string>()), m_Template("")
+: m_Template(""), m_Segments(), m_Slots(), m_Tags()
 {
 }
 
 MsgTemplate::MsgTemplate(const std::string& tplText)
-: m_Tags(std::map<std::string, std::string>()), m_Template(tplText)
+: m_Template(tplText), m_Segments(), m_Slots(), m_Tags()
 {
+  compile();
 }
 
 bool MsgTemplate::loadFromFile(const std::string& fileName)
@@ -40,100 +145,176 @@ bool MsgTemplate::loadFromFile(const std::string& fileName)
   {
     return false;
   }
-  const unsigned int buf_size = 4096;
-  char buffer[buf_size];
-
-  m_Template.clear();
-  while (!inputFile.eof())
+  std::string content((std::istreambuf_iterator<char>(inputFile)), std::istreambuf_iterator<char>());
+  if (inputFile.bad())
   {
-    memset(buffer, '\0', buf_size);
-    inputFile.read(buffer, buf_size - 1);
-    if (!inputFile.good())
-    {
-      if (!inputFile.eof())
-      {
-        inputFile.close();
-        return false;
-      }
-    }
-    m_Template += std::string(buffer);
+    inputFile.close();
+    return false;
   }
   inputFile.close();
+  m_Template = std::move(content);
+  compile();
   return true;
 }
 
 bool MsgTemplate::loadFromString(const std::string& tplText)
 {
   m_Template = tplText;
+  compile();
   return true;
 }
 
 void MsgTemplate::addReplacement(const std::string& tag, const std::string& replacement, const bool killHTML)
 {
-  m_Tags[tag] = prepareReplacement(replacement, killHTML);
+  // Templates only have a few distinct tags, so a linear search is fine.
+  for (Slot& slot : m_Slots)
+  {
+    if (slot.name == tag)
+    {
+      // Overwriting the previous value reuses its memory.
+      prepareReplacement(replacement, killHTML, slot.replacement);
+      slot.hasReplacement = true;
+      return;
+    }
+  }
+  prepareReplacement(replacement, killHTML, m_Tags[tag]);
 }
 
 void MsgTemplate::clearReplacements()
 {
+  for (Slot& slot : m_Slots)
+  {
+    slot.replacement.clear();
+    slot.hasReplacement = false;
+  }
   m_Tags.clear();
 }
 
 std::string MsgTemplate::show() const
 {
-  std::string result = m_Template;
-  for (const auto& tag : m_Tags)
+  std::string result;
+  render(result);
+  return result;
+}
+
+void MsgTemplate::render(std::string& out) const
+{
+  std::string::size_type total = out.size();
+  for (const Segment& segment : m_Segments)
   {
-    const std::string fullTag = "{.." + tag.first + "..}";
-    std::string::size_type pos = result.find(fullTag);
-    while (pos != std::string::npos)
-    {
-      result.replace(pos, fullTag.length(), tag.second);
-      pos = result.find(fullTag, pos);
-    }
+    if ((segment.slot != literal) && m_Slots[segment.slot].hasReplacement)
+      total += m_Slots[segment.slot].replacement.size();
+    else
+      total += segment.length;
+  }
+  out.reserve(total);
+
+  for (const Segment& segment : m_Segments)
+  {
+    if ((segment.slot != literal) && m_Slots[segment.slot].hasReplacement)
+      out.append(m_Slots[segment.slot].replacement);
+    else
+      out.append(m_Template, segment.offset, segment.length);
   }
-  return result;
 }
 
-std::string MsgTemplate::prepareReplacement(std::string content, const bool killHTML)
+const std::string& MsgTemplate::getTemplateText() const
 {
-  std::string::size_type pos = std::string::npos;
-  if (killHTML)
+  return m_Template;
+}
+
+void MsgTemplate::compile()
+{
+  // Keep the replacements of the previous template for the new one.
+  for (Slot& slot : m_Slots)
   {
-    pos = content.find("&");
-    while (pos != std::string::npos)
+    if (slot.hasReplacement)
+      m_Tags[slot.name] = std::move(slot.replacement);
+  }
+  m_Slots.clear();
+  m_Segments.clear();
+
+  std::string::size_type literalStart = 0;
+  std::string::size_type open = m_Template.find("{..");
+  while (open != std::string::npos)
+  {
+    const std::string::size_type close = m_Template.find("..}", open + 3);
+    if (close == std::string::npos)
+      break;
+    // A tag name cannot contain the start of another tag.
+    const std::string::size_type nextOpen = m_Template.find("{..", open + 1);
+    if (nextOpen < close)
     {
-      content.replace(pos, 1, "&amp;");
-      pos = content.find("&", pos + 1);
+      open = nextOpen;
+      continue;
     }
 
-    pos = content.find("<");
-    while (pos != std::string::npos)
+    const std::string name = m_Template.substr(open + 3, close - open - 3);
+    std::size_t index = 0;
+    while ((index < m_Slots.size()) && (m_Slots[index].name != name))
     {
-      content.replace(pos, 1, "&lt;");
-      pos = content.find("<", pos + 1);
+      ++index;
     }
-
-    pos = content.find(">");
-    while (pos != std::string::npos)
+    if (index == m_Slots.size())
     {
-      content.replace(pos, 1, "&gt;");
-      pos = content.find(">", pos + 1);
+      Slot slot{ name, std::string(), false };
+      const auto iter = m_Tags.find(name);
+      if (iter != m_Tags.end())
+      {
+        slot.replacement = std::move(iter->second);
+        slot.hasReplacement = true;
+        m_Tags.erase(iter);
+      }
+      m_Slots.push_back(std::move(slot));
     }
-  } // if escape HTML tags
 
-  pos = content.find("{..");
-  while (pos != std::string::npos)
+    if (open > literalStart)
+      m_Segments.push_back(Segment{ literalStart, open - literalStart, literal });
+    m_Segments.push_back(Segment{ open, close + 3 - open, index });
+    literalStart = close + 3;
+    open = m_Template.find("{..", literalStart);
+  }
+  if (literalStart < m_Template.size())
+    m_Segments.push_back(Segment{ literalStart, m_Template.size() - literalStart, literal });
+}
+
+void MsgTemplate::prepareReplacement(const std::string& content, const bool killHTML, std::string& prepared)
+{
+  const char* const data = content.data();
+  const std::size_t length = content.size();
+  std::size_t pos = findSpecialCharacter(data, 0, length, killHTML);
+  if (pos == length)
   {
-    content.replace(pos, 3, "&#x7B;..");
-    pos = content.find("{..", pos + 1);
+    prepared.assign(content);
+    return;
   }
 
-  pos = content.find("..}");
-  while (pos != std::string::npos)
+  // first pass: determine size of the result
+  std::size_t extra = 0;
+  for (std::size_t i = pos; i < length; i = findSpecialCharacter(data, i + 1, length, killHTML))
+  {
+    extra += escapeSequence(data, i, length, killHTML).size() - 1;
+  }
+  if (extra == 0)
   {
-    content.replace(pos, 3, "..&#x7D;");
-    pos = content.find("..}", pos + 1);
+    // only braces which do not belong to tag markers
+    prepared.assign(content);
+    return;
   }
 
-  return content;
+  // second pass: copy text between escaped characters in blocks
+  prepared.clear();
+  prepared.reserve(length + extra);
+  std::size_t copied = 0;
+  for (; pos < length; pos = findSpecialCharacter(data, pos + 1, length, killHTML))
+  {
+    const std::string_view sequence = escapeSequence(data, pos, length, killHTML);
+    if (sequence.size() > 1)
+    {
+      prepared.append(data + copied, pos - copied);
+      prepared.append(sequence);
+      copied = pos + 1;
+    }
+  }
+  prepared.append(data + copied, length - copied);
 }
@@ -1,7 +1,7 @@
 /*
  -------------------------------------------------------------------------------
     This file is part of the Private Message Database.
-    Copyright (C) 2012, 2014, 2017  Dirk Stolle
+    Copyright (C) 2012, 2014, 2017, 2026  Dirk Stolle
 
     This program is free software: you can redistribute it and/or modify
     it under the terms of the GNU General Public License as published by
@@ -21,11 +21,18 @@
 #ifndef MSGTEMPLATE_HPP
 #define MSGTEMPLATE_HPP
 
+#include <cstddef>
 #include <string>
 #include <map>
+#include <vector>
 
 
-/** class for templates */
+/** class for templates
+
+    Tags in the template have the form {..name..}. The template is split into
+    literal text and tags once when it is loaded, so showing it only needs to
+    append the parts one after another.
+*/
 class MsgTemplate
 {
   public:
@@ -78,20 +85,71 @@ class MsgTemplate
      * \return template with all tags replaced by proper content
      */
     std::string show() const;
+
+
+    /** \brief Appends the final template with all replacement tags replaced
+     * by their proper content to a string.
+     *
+     * \param out  the string to which the result is appended
+     * \remarks Tags without replacement are kept as they are.
+     */
+    void render(std::string& out) const;
+
+
+    /** \brief Gets the template text.
+     *
+     * \return Returns the template text, with tags and without replacements.
+     */
+    const std::string& getTemplateText() const;
   private:
+    /// value of Segment::slot for literal text
+    static constexpr std::size_t literal = static_cast<std::size_t>(-1);
+
+
+    /// part of the template text: either literal text or a tag
+    struct Segment
+    {
+      std::string::size_type offset; /**< start of the part in m_Template */
+      std::string::size_type length; /**< length of the part in m_Template */
+      std::size_t slot; /**< index in m_Slots for a tag, or literal */
+    };
+
+
+    /// distinct tag of the template and its current replacement
+    struct Slot
+    {
+      std::string name; /**< name of the tag */
+      std::string replacement; /**< prepared replacement */
+      bool hasReplacement; /**< whether a replacement has been set */
+    };
+
+
+    /** \brief Splits the template text into literal text and tags, and moves
+     * replacements of tags that occur in the template into their slots.
+     */
+    void compile();
+
+
     /** \brief Prepares a replacement string by escaping HTML code (if specified
      * via @killHTML) and some other character sequences with special meaning.
      *
      * \param content    replacement string
      * \param killHTML   if set to true, HTML code will be escaped in the
      *                   replacement string
-     * \return prepared version of @content
+     * \param prepared   string that gets the prepared version of @content; its
+     *                   previous content is replaced
+     * \remarks The string is scanned once for characters that may need to be
+     * escaped. If there are none, @content is just copied into @prepared.
+     * Otherwise the size of the result is calculated first, and the result is
+     * written in a single pass.
      */
-    std::string prepareReplacement(std::string content, const bool killHTML);
+    static void prepareReplacement(const std::string& content, const bool killHTML, std::string& prepared);
 
 
-    std::map<std::string, std::string> m_Tags; /**< tag map; key = name, value = replacement */
     std::string m_Template; /**< template text */
+    std::vector<Segment> m_Segments; /**< parts of the template in order */
+    std::vector<Slot> m_Slots; /**< tags of the template */
+    std::map<std::string, std::string> m_Tags; /**< replacements of tags which do not occur in the template; key = name, value = replacement */
 }; //class
 
 #endif // MSGTEMPLATE_HPP
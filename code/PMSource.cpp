@@ -1,7 +1,7 @@
 /*
  -------------------------------------------------------------------------------
     This file is part of the Private Message Database.
-    Copyright (C) 2012, 2014, 2016  Dirk Stolle
+    Copyright (C) 2012, 2014, 2016, 2026  Dirk Stolle
 
     This program is free software: you can redistribute it and/or modify
     it under the terms of the GNU General Public License as published by
@@ -19,67 +19,64 @@
 */
 
 #include "PMSource.hpp"
+#include <algorithm>
 #include <cstring>
-#ifdef DEBUG
-  #include <iostream>
-#endif
 #include <stdexcept>
 #include "../libstriezel/common/StringUtils.hpp"
-#include "../libstriezel/common/BufferStream.hpp"
 
 namespace SHA256
 {
 
+/** \brief Gets a view of a string that includes its terminating NUL character. */
+inline std::string_view withTerminator(const std::string& str)
+{
+  return std::string_view(str.c_str(), str.length() + 1);
+}
+
+/** \brief Extends a view by the NUL character that follows it. */
+inline std::string_view withTerminator(const std::string_view view)
+{
+  return std::string_view(view.data(), view.size() + 1);
+}
+
 PMSource::PMSource(const PrivateMessage& pm)
+: m_UserID(uintToString(pm.getFromUserID())),
+  m_DatestampBuffer(),
+  m_Fields({ withTerminator(pm.getCompactDatestamp().view(m_DatestampBuffer)), withTerminator(pm.getTitle()),
+             withTerminator(pm.getFromUser()), withTerminator(m_UserID),
+             withTerminator(pm.getToUser()), withTerminator(pm.getMessage()) }),
+  m_CurrentField(0),
+  m_Offset(0)
 {
-  const std::string uid_string = uintToString(pm.getFromUserID());
-  const std::string::size_type origLen =
-        pm.getDatestamp().length() + 1
-      + pm.getTitle().length() + 1
-      + pm.getFromUser().length() + 1
-      + uid_string.length() + 1
-      + pm.getToUser().length() + 1
-      + pm.getMessage().length() + 1;
-  m_PaddingBuffer = new uint8_t[origLen];
-  //copy datestamp
-  uint64_t done = pm.getDatestamp().length() + 1;
-  memcpy(&m_PaddingBuffer[0], pm.getDatestamp().c_str(), done);
-  //copy title
-  memcpy(&m_PaddingBuffer[done], pm.getTitle().c_str(), pm.getTitle().length() + 1);
-  done = done + pm.getTitle().length() + 1;
-  //copy fromUser
-  memcpy(&m_PaddingBuffer[done], pm.getFromUser().c_str(), pm.getFromUser().length() + 1);
-  done = done + pm.getFromUser().length() + 1;
-  //copy fromUserID
-  memcpy(&m_PaddingBuffer[done], uid_string.c_str(), uid_string.length() + 1);
-  done = done + uid_string.length() + 1;
-  //copy toUser
-  memcpy(&m_PaddingBuffer[done], pm.getToUser().c_str(), pm.getToUser().length() + 1);
-  done = done + pm.getToUser().length() + 1;
-  //copy message
-  memcpy(&m_PaddingBuffer[done], pm.getMessage().c_str(), pm.getMessage().length() + 1);
-  done = done + pm.getMessage().length() + 1;
-  #ifdef DEBUG
-  if (done!=origLen)
+  m_BitsRead = 0;
+}
+
+std::size_t PMSource::readData(uint8_t* dest, std::size_t count)
+{
+  std::size_t copied = 0;
+  while ((copied < count) && (m_CurrentField < m_Fields.size()))
   {
-    std::cout << "Number of written bytes does not match expected number!\n";
-    throw std::runtime_error("PMSource::PMSource(): Number of written bytes does not match expected number!");
+    const std::string_view& field = m_Fields[m_CurrentField];
+    const std::size_t chunk = std::min(count - copied, field.size() - m_Offset);
+    std::memcpy(dest + copied, field.data() + m_Offset, chunk);
+    copied += chunk;
+    m_Offset += chunk;
+    if (m_Offset == field.size())
+    {
+      ++m_CurrentField;
+      m_Offset = 0;
+    }
   }
-  #endif
-  m_BufStream.buffer(reinterpret_cast<const char*>(m_PaddingBuffer), origLen);
-  m_BitsRead = 0;
-  // BufferStream takes care of pointer, so we set it to NULL here to avoid conflicts.
-  m_PaddingBuffer = nullptr;
+  return copied;
 }
 
 bool PMSource::getNextMessageBlock(MessageBlock& mBlock)
 {
-  std::streamsize bytesRead = 0;
+  std::size_t bytesRead = 0;
   switch (m_Status)
   {
     case psUnpadded:
-         m_BufStream.read(reinterpret_cast<char*>(&(mBlock.words[0])), 64);
-         bytesRead = m_BufStream.gcount();
+         bytesRead = readData(reinterpret_cast<uint8_t*>(&(mBlock.words[0])), 64);
          if (bytesRead == 64)
          {
            m_BitsRead += 512;
@@ -88,8 +85,6 @@ bool PMSource::getNextMessageBlock(MessageBlock& mBlock)
          }
          //not full block read
          m_BitsRead += (bytesRead * 8);
-         //close file, we are done here with reading from file anyway
-         //m_BufStream.close(); // no close, since this will take care of itself in destructor
          //add 1-bit (start of message padding)
          ((uint8_t*) &(mBlock.words[0]))[bytesRead] = 0x80;
          //zero out rest of message block
@@ -1,7 +1,7 @@
 /*
  -------------------------------------------------------------------------------
     This file is part of the Private Message Database.
-    Copyright (C) 2012, 2014  Dirk Stolle
+    Copyright (C) 2012, 2014, 2026  Dirk Stolle
 
     This program is free software: you can redistribute it and/or modify
     it under the terms of the GNU General Public License as published by
@@ -21,8 +21,11 @@
 #ifndef PMSOURCE_HPP
 #define PMSOURCE_HPP
 
+#include <array>
+#include <cstddef>
+#include <string>
+#include <string_view>
 #include "PrivateMessage.hpp"
-#include "../libstriezel/common/BufferStream.hpp"
 #include "../libstriezel/hash/sha256/MessageSource.hpp"
 
 namespace SHA256
@@ -30,6 +33,11 @@ namespace SHA256
 
 /** Class that uses a PrivateMessage class instance as message source
  *  for SHA-256 hash calculation.
+ *
+ *  The data of the message is the sequence of the six NUL-terminated fields.
+ *  The message blocks are filled directly from the strings of the message,
+ *  so the message has to outlive the PMSource instance and must not change
+ *  while the hash is calculated.
  */
 class PMSource: public MessageSource
 {
@@ -38,6 +46,10 @@ class PMSource: public MessageSource
     PMSource(const PrivateMessage& pm);
 
 
+    PMSource(const PMSource& op) = delete;
+    PMSource& operator=(const PMSource& op) = delete;
+
+
     /** \brief Puts the next message block from the source in mBlock.
      *
      * \param mBlock   reference to the message blocked that should be filled
@@ -47,7 +59,20 @@ class PMSource: public MessageSource
      */
     virtual bool getNextMessageBlock(MessageBlock& mBlock);
   private:
-    libstriezel::InBufferStream m_BufStream;
+    /** \brief Copies the next bytes of the message data.
+     *
+     * \param dest   pointer to the destination
+     * \param count  maximum number of bytes to copy
+     * \return Returns the number of bytes that were copied. This is less than
+     *         count only at the end of the data.
+     */
+    std::size_t readData(uint8_t* dest, std::size_t count);
+
+    std::string m_UserID; /**< user ID of the sender as decimal string */
+    Datestamp::Buffer m_DatestampBuffer; /**< text of a packed datestamp */
+    std::array<std::string_view, 6> m_Fields; /**< fields, including the terminating NUL */
+    std::size_t m_CurrentField; /**< index of the field that is read next */
+    std::size_t m_Offset; /**< offset of the next byte in the current field */
 }; // class
 
 } // namespace
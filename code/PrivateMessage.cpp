@@ -1,7 +1,7 @@
 /*
  -------------------------------------------------------------------------------
     This file is part of the Private Message Database.
-    Copyright (C) 2012, 2014, 2015, 2016, 2025  Dirk Stolle
+    Copyright (C) 2012, 2014, 2015, 2016, 2025, 2026  Dirk Stolle
 
     This program is free software: you can redistribute it and/or modify
     it under the terms of the GNU General Public License as published by
@@ -19,39 +19,61 @@
 */
 
 #include "PrivateMessage.hpp"
+#include <algorithm>
+#include <charconv>
+#include <cstring>
 #include <fstream>
 #ifdef DEBUG
   #include <iostream>
 #endif
 #include <limits>
-#include <sstream>
+#include <stdexcept>
+#include <string_view>
+#include "MappedFile.hpp"
 #include "PMSource.hpp"
+#include "sha256_backend.hpp"
+#include "StringPool.hpp"
+#include "../libstriezel/common/BufferStream.hpp"
 #include "../libstriezel/common/StringUtils.hpp"
 #ifndef NO_PM_COMPRESSION
 #include "../libstriezel/zlib/CompressionFunctions.hpp"
 #endif
 
 PrivateMessage::PrivateMessage()
-: datestamp(""),
+: datestamp(Datestamp()),
   title(""),
-  fromUser(""),
+  fromUser(&pmdb::intern("")),
   fromUserID(0),
-  toUser(""),
+  toUser(&pmdb::intern("")),
   message(""),
+  m_Location(nullptr),
   m_NeedsHashUpdate(true),
   m_Hash(SHA256::MessageDigest())
 {
 }
 
-void PrivateMessage::normalise()
+bool PrivateMessage::normalise()
 {
+  getMessage();
   std::string::size_type pos = message.find("\r\n");
+  if (pos == std::string::npos)
+    return false;
+
+  // Drop the CR of every CR+LF by moving the text between two line breaks
+  // to the front only once, so the work is linear in the length of the text.
+  char* const data = message.data();
+  std::string::size_type out = pos;
   while (pos != std::string::npos)
   {
-    message.replace(pos, 2, "\n");
-    m_NeedsHashUpdate = true;
-    pos = message.find("\r\n", pos);
+    const std::string::size_type start = pos + 1;
+    pos = message.find("\r\n", start);
+    const std::string::size_type end = (pos == std::string::npos) ? message.size() : pos;
+    std::copy(data + start, data + end, data + out);
+    out += end - start;
   }
+  message.resize(out);
+  m_NeedsHashUpdate = true;
+  return true;
 }
 
 const SHA256::MessageDigest& PrivateMessage::getHash()
@@ -59,27 +81,33 @@ const SHA256::MessageDigest& PrivateMessage::getHash()
   if (m_NeedsHashUpdate)
   {
     SHA256::PMSource pms(*this);
-    m_Hash = SHA256::computeFromSource(pms);
+    m_Hash = pmdb::sha256::computeFromSource(pms);
     m_NeedsHashUpdate = false;
   }
   return m_Hash;
 }
 
+void PrivateMessage::setHash(const SHA256::MessageDigest& digest)
+{
+  m_Hash = digest;
+  m_NeedsHashUpdate = false;
+}
+
 void PrivateMessage::setDatestamp(const std::string& ds)
 {
-  datestamp = ds;
+  datestamp = Datestamp(ds);
   m_NeedsHashUpdate = true;
 }
 
-void PrivateMessage::setTitle(const std::string& t)
+void PrivateMessage::setTitle(std::string t)
 {
-  title = t;
+  title = std::move(t);
   m_NeedsHashUpdate = true;
 }
 
 void PrivateMessage::setFromUser(const std::string& from)
 {
-  fromUser = from;
+  fromUser = &pmdb::intern(from);
   m_NeedsHashUpdate = true;
 }
 
@@ -91,20 +119,21 @@ void PrivateMessage::setFromUserID(const uint32_t uid)
 
 void PrivateMessage::setToUser(const std::string& to)
 {
-  toUser = to;
+  toUser = &pmdb::intern(to);
   m_NeedsHashUpdate = true;
 }
 
-void PrivateMessage::setMessage(const std::string& msg)
+void PrivateMessage::setMessage(std::string msg)
 {
-  message = msg;
+  message = std::move(msg);
+  m_Location.reset();
   m_NeedsHashUpdate = true;
 }
 
 std::string::size_type PrivateMessage::getSaveSize() const
 {
   const std::string uid_string = uintToString(getFromUserID());
-  return getDatestamp().length() + 1
+  return datestamp.length() + 1
        + getTitle().length() + 1
        + getFromUser().length() + 1
        + uid_string.length() + 1
@@ -115,34 +144,54 @@ std::string::size_type PrivateMessage::getSaveSize() const
 bool PrivateMessage::saveToStream(std::ostream& outputStream) const
 {
   // write datestamp
-  outputStream.write(datestamp.c_str(), datestamp.length() + 1);
+  Datestamp::Buffer buffer;
+  const std::string_view ds = datestamp.view(buffer);
+  outputStream.write(ds.data(), ds.size() + 1);
   // write title
   outputStream.write(title.c_str(), title.length() + 1);
   // write fromUser
-  outputStream.write(fromUser.c_str(), fromUser.length() + 1);
+  outputStream.write(fromUser->c_str(), fromUser->length() + 1);
   // write fromUserID
   const std::string uid_string = uintToString(fromUserID);
   outputStream.write(uid_string.c_str(), uid_string.length() + 1);
   // write toUser
-  outputStream.write(toUser.c_str(), toUser.length() + 1);
+  outputStream.write(toUser->c_str(), toUser->length() + 1);
   // write message text
-  outputStream.write(message.c_str(), message.length() + 1);
+  const std::string& text = getMessage();
+  outputStream.write(text.c_str(), text.length() + 1);
   return outputStream.good();
 }
 
-bool PrivateMessage::saveToFile(const std::string& fileName, const Compression compression) const
+bool PrivateMessage::saveToBuffer(std::string& data, const Compression compression) const
 {
-  if (compression == Compression::none)
+  std::string::size_type bufLen = 0;
+  std::string plain;
+  try
   {
-    std::ofstream output;
-    output.open(fileName, std::ios_base::out | std::ios_base::binary);
-    if (!output)
+    // A released message text is read again here, which may fail.
+    bufLen = getSaveSize();
+    plain.assign(bufLen, '\0');
+    libstriezel::OutBufferStream bufferStream(plain.data(), bufLen);
+    if (!saveToStream(bufferStream))
     {
+      #ifdef DEBUG
+      std::cerr << "Error while saving private message: Could not write data to buffer stream!\n";
+      #endif
       return false;
     }
-    const bool result = saveToStream(output);
-    output.close();
-    return result;
+  }
+  catch (const std::runtime_error& ex)
+  {
+    #ifdef DEBUG
+    std::cerr << "Error while saving private message: " << ex.what() << "\n";
+    #endif
+    return false;
+  }
+
+  if (compression == Compression::none)
+  {
+    data = std::move(plain);
+    return true;
   } // if not compressed
   else
   {
@@ -152,36 +201,6 @@ bool PrivateMessage::saveToFile(const std::string& fileName, const Compression c
     #endif
     return false;
     #else
-    const std::string::size_type bufLen = getSaveSize();
-    uint8_t * buffer = nullptr;
-    try
-    {
-      buffer = new uint8_t[bufLen];
-    }
-    catch (...)
-    {
-      #ifdef DEBUG
-      std::cout << "Error while saving private message: could not allocate buffer for compression!\n";
-      #endif
-      if (buffer != nullptr)
-      {
-        delete [] buffer;
-      }
-      return false;
-    }
-
-    libstriezel::OutBufferStream bufferStream(reinterpret_cast<char*>(buffer), bufLen);
-    const bool result = saveToStream(bufferStream);
-    if (!result)
-    {
-      #ifdef DEBUG
-      std::cerr << "Error while saving private message: Could not write data to buffer stream!\n";
-      #endif
-      delete[] buffer;
-      buffer = nullptr;
-      return false;
-    }
-
     uint32_t compSize = 0;
     if (bufLen > std::numeric_limits<uint32_t>::max())
       compSize = std::numeric_limits<uint32_t>::max();
@@ -189,294 +208,283 @@ bool PrivateMessage::saveToFile(const std::string& fileName, const Compression c
       compSize = bufLen;
     libstriezel::zlib::CompressPointer compressedData = new uint8_t[compSize];
     uint32_t usedSize = 0;
-    if (!libstriezel::zlib::compress(buffer, bufLen, compressedData, compSize, usedSize, 9))
+    if (!libstriezel::zlib::compress(reinterpret_cast<uint8_t*>(plain.data()), bufLen, compressedData, compSize, usedSize, 9))
     {
       #ifdef DEBUG
       std::cerr << "Error while saving compressed message: Compression via zlib failed!\n";
       #endif
-      delete[] buffer;
-      buffer = nullptr;
       delete[] compressedData;
       compressedData = nullptr;
       return false;
     }
-    std::ofstream output;
-    output.open(fileName, std::ios_base::out | std::ios_base::binary);
-    if (!output)
-    {
-      delete[] buffer;
-      buffer = nullptr;
-      delete[] compressedData;
-      compressedData = nullptr;
-      return false;
-    }
-    // Write original length value, so we can use it to allocate proper buffer size for decompression.
+    // Store original length value, so it can be used to allocate proper buffer size for decompression.
     const uint32_t origLen = bufLen;
-    output.write(reinterpret_cast<const char*>(&origLen), sizeof(uint32_t));
-    //write compressed data
-    output.write(reinterpret_cast<const char*>(compressedData), usedSize);
-    const bool success = output.good();
-    output.close();
-    delete[] buffer;
-    buffer = nullptr;
+    data.assign(reinterpret_cast<const char*>(&origLen), sizeof(uint32_t));
+    data.append(reinterpret_cast<const char*>(compressedData), usedSize);
     delete[] compressedData;
     compressedData = nullptr;
-    return success;
+    return true;
     #endif // end of NO_PM_COMPRESSION is not defined
   } // else (i.e. shall save compressed PM data)
 }
 
-bool PrivateMessage::loadFromStream(std::istream& inputStream)
+bool PrivateMessage::saveToFile(const std::string& fileName, const Compression compression) const
 {
-  inputStream.seekg(0, std::ios_base::end);
-  const std::streamsize len = inputStream.tellg();
-  inputStream.seekg(0, std::ios_base::beg);
-  if (!inputStream.good())
+  std::string data;
+  if (!saveToBuffer(data, compression))
+  {
+    return false;
+  }
+  std::ofstream output;
+  output.open(fileName, std::ios_base::out | std::ios_base::binary);
+  if (!output)
   {
-    #ifdef DEBUG
-    std::cout << "Error while reading private message: seek operation(s) failed!\n";
-    #endif
     return false;
   }
+  output.write(data.c_str(), data.length());
+  const bool success = output.good();
+  output.close();
+  return success;
+}
+
+bool PrivateMessage::loadFromBuffer(const char* data, const std::size_t size, const Compression compression)
+{
+  if (compression == Compression::zlib)
+  {
+    #ifdef NO_PM_COMPRESSION
+    #ifdef DEBUG
+    std::cout << "Error while loading compressed private message: (de-)compression is disabled for this build!\n";
+    #endif //DEBUG
+    return false;
+    #else
+    uint32_t decompressedSize = 0;
+    if (size < sizeof(uint32_t))
+    {
+      #ifdef DEBUG
+      std::cout << "Error while reading private message: Could not read size value!\n";
+      #endif
+      return false;
+    }
+    std::memcpy(&decompressedSize, data, sizeof(uint32_t));
+
+    /* Check for size to avoid allocating an excessive amount of memory.
+       Size should not be zero (empty buffer is useless), and it should not be
+       more than 1 MB, which is more than enough for a PM.
+    */
+    if ((decompressedSize == 0) || (decompressedSize > 1024*1024))
+    {
+      #ifdef DEBUG
+      std::cerr << "Error while reading private message: Encountered invalid decompression size value of "
+                << decompressedSize << " bytes! Size should be in [1;" << 1024*1024 << "].\n";
+      #endif
+      return false;
+    }
+
+    const std::size_t compressedBufferSize = size - sizeof(uint32_t);
+    if ((compressedBufferSize > 1024*1024) || (compressedBufferSize == 0))
+    {
+      #ifdef DEBUG
+      std::cerr << "Error while reading private message: Encountered invalid compression buffer size value of "
+                << compressedBufferSize << " bytes! Size should be in [1;" << 1024 * 1024 << "].\n";
+      #endif
+      return false;
+    }
+
+    // decompress all the stuff
+    std::string decompressed(decompressedSize, '\0');
+    const uint8_t * compressedBuffer = reinterpret_cast<const uint8_t*>(data + sizeof(uint32_t));
+    if (!libstriezel::zlib::decompress(const_cast<uint8_t*>(compressedBuffer), compressedBufferSize,
+                                      reinterpret_cast<uint8_t*>(decompressed.data()), decompressedSize))
+    {
+      #ifdef DEBUG
+      std::cout << "Error while reading private message: Decompression failed!\n";
+      #endif
+      return false;
+    } // if zlib decompression failed
+
+    return loadFromBuffer(decompressed.c_str(), decompressed.length(), Compression::none);
+    #endif // NO_PM_COMPRESSION is not defined
+  } //if compressed
+
   // We do not want PMs larger than 1 MB, to avoid excessive memory consumption.
-  if (len > 1024 * 1024)
+  if (size > 1024 * 1024)
   {
     #ifdef DEBUG
-    std::cerr << "Error while reading private message: Unexpected large file size!\n";
+    std::cerr << "Error while reading private message: Unexpected large size!\n";
     #endif
     return false;
   }
-  // assume worst case for buffer size: all file content should fit into it
-  char * buffer = new char[len + 1];
 
-  // read datestamp
-  inputStream.getline(buffer, len, '\0');
-  if (!inputStream.good())
+  // The fields are parsed directly from the buffer, each field has to be
+  // terminated by a NUL byte.
+  const char * position = data;
+  const char * const end = data + size;
+  const auto nextView = [&position, end](std::string_view& field)
+  {
+    if (position == end)
+      return false;
+    const void * terminator = std::memchr(position, '\0', end - position);
+    if (terminator == nullptr)
+      return false;
+    field = std::string_view(position, static_cast<const char*>(terminator) - position);
+    position = static_cast<const char*>(terminator) + 1;
+    return true;
+  };
+  const auto nextField = [&nextView](std::string& field)
+  {
+    std::string_view view;
+    if (!nextView(view))
+      return false;
+    field.assign(view.data(), view.size());
+    return true;
+  };
+  const auto nextUser = [&nextView](const std::string*& user)
+  {
+    std::string_view view;
+    if (!nextView(view))
+      return false;
+    user = &pmdb::intern(view);
+    return true;
+  };
+
+  m_NeedsHashUpdate = true;
+  m_Location.reset();
+  std::string_view ds;
+  if (!nextView(ds))
   {
     #ifdef DEBUG
     std::cerr << "Error while reading private message's datestamp part!\n";
     #endif
-    delete[] buffer;
     return false;
   }
-  buffer[inputStream.gcount()] = '\0';
-  datestamp = std::string(buffer);
-  m_NeedsHashUpdate = true;
-
-  // read title
-  inputStream.getline(buffer, len, '\0');
-  if (!inputStream.good())
+  datestamp = Datestamp(ds);
+  if (!nextField(title))
   {
     #ifdef DEBUG
     std::cerr << "Error while reading private message's title part!\n";
     #endif
-    delete[] buffer;
     return false;
   }
-  buffer[inputStream.gcount()] = '\0';
-  title = std::string(buffer);
-
-  // read fromUser
-  inputStream.getline(buffer, len, '\0');
-  if (!inputStream.good())
+  if (!nextUser(fromUser))
   {
     #ifdef DEBUG
     std::cerr << "Error while reading private message's sender part!\n";
     #endif
-    delete[] buffer;
     return false;
   }
-  buffer[inputStream.gcount()] = '\0';
-  fromUser = std::string(buffer);
-
-  // read fromUserID
-  inputStream.getline(buffer, len, '\0');
-  if (!inputStream.good())
+  const char * const uidStart = position;
+  std::string_view uid;
+  if (!nextView(uid))
   {
     #ifdef DEBUG
     std::cerr << "Error while reading private message's user ID!\n";
     #endif
-    delete[] buffer;
     return false;
   }
-  buffer[inputStream.gcount()] = '\0';
-  const std::string tempStr = std::string(buffer);
-  if (!(std::stringstream (tempStr) >> fromUserID))
+  const auto [uidEnd, error] = std::from_chars(uidStart, uidStart + uid.length(), fromUserID);
+  if ((error != std::errc()) || (uidEnd != uidStart + uid.length()))
   {
     #ifdef DEBUG
     std::cerr << "Error while converting private message's user ID string to integer!\n";
     #endif
-    delete[] buffer;
     return false;
   }
-
-  // read toUser
-  inputStream.getline(buffer, len, '\0');
-  if (!inputStream.good())
+  if (!nextUser(toUser))
   {
     #ifdef DEBUG
     std::cerr << "Error while reading private message's receiver!\n";
     #endif
-    delete[] buffer;
     return false;
   }
-  buffer[inputStream.gcount()] = '\0';
-  toUser = std::string(buffer);
-
-  // read message text
-  inputStream.getline(buffer, len, '\0');
-  if (!inputStream.good())
+  if (!nextField(message))
   {
     #ifdef DEBUG
     std::cerr << "Error while reading private message's text!\n";
     #endif
-    delete[] buffer;
     return false;
   }
-  buffer[inputStream.gcount()] = '\0';
-  message = std::string(buffer);
-  m_NeedsHashUpdate = true;
-  // free previously allocated buffer
-  delete[] buffer;
-
   return true;
 }
 
 bool PrivateMessage::loadFromFile(const std::string& fileName, const Compression compression)
 {
+  #ifdef NO_PM_COMPRESSION
   if (compression == Compression::zlib)
   {
-    #ifdef NO_PM_COMPRESSION
     #ifdef DEBUG
     std::cout << "Error while loading compressed private message: (de-)compression is disabled for this build!\n";
     #endif //DEBUG
     return false;
-    #else
-    std::ifstream input;
-    input.open(fileName, std::ios_base::in | std::ios_base::binary);
-    if (!input)
-    {
-      return false;
-    }
-
-    uint32_t decompressedSize = 0;
-    input.read(reinterpret_cast<char*>(&decompressedSize), sizeof(uint32_t));
-    if (!input.good() || (input.gcount() != sizeof(uint32_t)))
-    {
-      input.close();
-      #ifdef DEBUG
-      std::cout << "Error while reading private message: Could not read size value!\n";
-      #endif
-      return false;
-    }
-
-    /* Check for size to avoid allocating an excessive amount of memory.
-       Size should not be zero (empty buffer is useless), and it should not be
-       more than 1 MB, which is more than enough for a PM.
-    */
-    if ((decompressedSize == 0) || (decompressedSize > 1024*1024))
-    {
-      input.close();
-      #ifdef DEBUG
-      std::cerr << "Error while reading private message: Encountered invalid decompression size value of "
-                << decompressedSize << " bytes! Size should be in [1;" << 1024*1024 << "].\n";
-      #endif
-      return false;
-    }
-
-    // get total length of file
-    input.seekg(0, std::ios_base::end);
-    const std::streamsize len = input.tellg();
-    // reset stream pointer to fifth byte (four have already been read)
-    input.seekg(sizeof(uint32_t), std::ios_base::beg);
-    if (!input.good())
-    {
-      input.close();
-      #ifdef DEBUG
-      std::cerr << "Error while reading private message: Seek operation(s) failed!\n";
-      #endif
-      return false;
-    }
-
-    const std::streamsize compressedBufferSize = len - 4;
-    if ((compressedBufferSize > 1024*1024) || (compressedBufferSize <= 0))
-    {
-      input.close();
-      #ifdef DEBUG
-      std::cerr << "Error while reading private message: Encountered invalid compression buffer size value of "
-                << compressedBufferSize << " bytes! Size should be in [1;" << 1024 * 1024 << "].\n";
-      #endif
-      return false;
-    }
-
-    // allocate buffer for compressed data
-    uint8_t * compressedBuffer = new uint8_t[compressedBufferSize];
-    // read all data into buffer
-    input.read(reinterpret_cast<char*> (compressedBuffer), compressedBufferSize);
-    if (!input.good() || (input.gcount() != compressedBufferSize))
-    {
-      input.close();
-      delete[] compressedBuffer;
-      #ifdef DEBUG
-      std::cout << "Error while reading private message: Could not read all compressed data!\n";
-      #endif
-      return false;
-    }
-    // We can close the input stream now, because all data was read from the stream.
-    input.close();
-
-    // allocate buffer for decompressed data
-    uint8_t * decompressedBuffer = new uint8_t[decompressedSize];
+  }
+  #endif // NO_PM_COMPRESSION
 
-    // decompress all the stuff
-    if (!libstriezel::zlib::decompress(compressedBuffer, compressedBufferSize, decompressedBuffer, decompressedSize))
-    {
-      delete[] compressedBuffer;
-      delete[] decompressedBuffer;
-      #ifdef DEBUG
-      std::cout << "Error while reading private message: Decompression failed!\n";
-      #endif
-      return false;
-    } // if zlib decompression failed
+  MappedFile file;
+  if (!file.open(fileName))
+  {
+    return false;
+  }
+  return loadFromBuffer(file.data(), file.size(), compression);
+}
 
-    // Compression succeeded, we can delete compressed buffer.
-    delete[] compressedBuffer;
-    compressedBuffer = nullptr;
+void PrivateMessage::releaseMessage(const Location& location)
+{
+  message.clear();
+  message.shrink_to_fit();
+  m_Location = std::make_shared<const Location>(location);
+}
 
-    // create buffer stream
-    libstriezel::InBufferStream bufferStream(reinterpret_cast<const char*>(decompressedBuffer), decompressedSize);
-    const bool success = loadFromStream(bufferStream);
-    bufferStream.buffer(nullptr, 0);
-    delete[] decompressedBuffer;
-    decompressedBuffer = nullptr;
+bool PrivateMessage::isMessageLoaded() const
+{
+  return m_Location == nullptr;
+}
 
-    return success;
-    #endif // NO_PM_COMPRESSION is not defined
-  } //if compressed
+void PrivateMessage::loadMessage() const
+{
+  const Location& location = *m_Location;
+  PrivateMessage complete;
+  bool success = false;
+  std::string fileName = *location.path;
+  if (location.size == 0)
+  {
+    fileName += location.digest.toHexString();
+    MappedFile file;
+    success = file.open(fileName)
+           && complete.loadFromBuffer(file.data(), file.size(), location.compression);
+  }
   else
   {
-    std::ifstream input;
-    input.open(fileName, std::ios_base::in | std::ios_base::binary);
-    if (!input)
-    {
-      return false;
-    }
-    const bool success = loadFromStream(input);
-    input.close();
-    return success;
-  } // else (i.e. uncompressed)
+    std::ifstream stream(fileName, std::ios_base::in | std::ios_base::binary);
+    std::string data(location.size, '\0');
+    success = stream.seekg(static_cast<std::streamoff>(location.offset)).read(data.data(), location.size).good()
+           && complete.loadFromBuffer(data.c_str(), data.size(), location.compression);
+  }
+  if (!success)
+  {
+    throw std::runtime_error("The text of a message could not be read from "
+                             + fileName + "!");
+  }
+  // The whole message is hashed again, so that a changed text is noticed.
+  if (complete.getHash() != location.digest)
+  {
+    throw std::runtime_error("Content of message " + location.digest.toHexString()
+                             + " in " + fileName + " has been altered!");
+  }
+  message = std::move(complete.message);
+  m_Location.reset();
 }
 
 bool PrivateMessage::operator==(const PrivateMessage& other) const
 {
+  // User names are pooled, so equal names have the same address.
   return ((datestamp == other.datestamp) && (title == other.title)
       && (fromUser == other.fromUser) && (fromUserID == other.fromUserID)
-      && (toUser == other.toUser) && (message == other.message));
+      && (toUser == other.toUser) && (getMessage() == other.getMessage()));
 }
 
 bool PrivateMessage::operator!=(const PrivateMessage& other) const
 {
+  // User names are pooled, so equal names have the same address.
   return ((datestamp != other.datestamp) || (title != other.title)
       || (fromUser != other.fromUser) || (fromUserID != other.fromUserID)
-      || (toUser != other.toUser) || (message != other.message));
+      || (toUser != other.toUser) || (getMessage() != other.getMessage()));
 }
@@ -1,7 +1,7 @@
 /*
  -------------------------------------------------------------------------------
     This file is part of the Private Message Database.
-    Copyright (C) 2012, 2014, 2015, 2025  Dirk Stolle
+    Copyright (C) 2012, 2014, 2015, 2025, 2026  Dirk Stolle
 
     This program is free software: you can redistribute it and/or modify
     it under the terms of the GNU General Public License as published by
@@ -21,27 +21,66 @@
 #ifndef PRIVATEMESSAGE_HPP
 #define PRIVATEMESSAGE_HPP
 
+#include <cstddef>
 #include <cstdint>
+#include <memory>
 #include <string>
 #include "Compression.hpp"
+#include "Datestamp.hpp"
 #include "../libstriezel/hash/sha256/sha256.hpp"
 
-/** Holds information about a private message. */
+/** Holds information about a private message.
+
+    User names are kept in the string pool (see StringPool.hpp), because the
+    same few names occur in many messages, and the datestamp is stored in its
+    compact form (see Datestamp.hpp). So the memory of a message is mostly
+    used by its title and its text.
+*/
 class PrivateMessage
 {
   public:
+    /** location of a serialised message, see releaseMessage()
+
+        The message is either a record in a message pack, or a message file
+        that is named by the digest of the message. The path is shared by all
+        messages of the same pack or directory.
+    */
+    struct Location
+    {
+      std::shared_ptr<const std::string> path; /**< path of the pack file, or of the directory with the message file (including trailing slash) */
+      std::uint64_t offset; /**< offset of the record in the pack file */
+      std::uint32_t size; /**< size of the record in the pack file, zero for a message file */
+      Compression compression; /**< compression of the serialised message */
+      SHA256::MessageDigest digest; /**< digest of the message */
+    };
+
+
     PrivateMessage();
 
 
-    /** Normalises the line breaks in the message text. */
-    void normalise();
+    /** \brief Normalises the line breaks in the message text.
+     *
+     * \return Returns true, if the text contained CR+LF line breaks which
+     *         have been replaced by LF. Returns false, if it was unchanged.
+     */
+    bool normalise();
 
 
     /** \brief Gets PM's datestamp.
      *
      * \return datestamp (string)
      */
-    inline const std::string& getDatestamp() const
+    inline std::string getDatestamp() const
+    {
+      return datestamp.toString();
+    }
+
+
+    /** \brief Gets PM's datestamp in its compact form.
+     *
+     * \return datestamp
+     */
+    inline const Datestamp& getCompactDatestamp() const
     {
       return datestamp;
     }
@@ -63,7 +102,7 @@ class PrivateMessage
      */
     inline const std::string& getFromUser() const
     {
-      return fromUser;
+      return *fromUser;
     }
 
 
@@ -84,20 +123,45 @@ class PrivateMessage
      */
     inline const std::string& getToUser() const
     {
-      return toUser;
+      return *toUser;
     }
 
 
     /** \brief Gets the text of the PM.
      *
      * \return message text
+     * \remarks If the text has been released, it is read from its file first.
+     *          Throws std::runtime_error, if that fails. This must not happen
+     *          for the same PM on several threads at the same time.
      */
     inline const std::string& getMessage() const
     {
+      if (m_Location)
+      {
+        loadMessage();
+      }
       return message;
     }
 
 
+    /** \brief Frees the memory of the message text. The text will be read
+     *         again from the given location when it is needed.
+     *
+     * \param location  location of the serialised PM, the file has to stay
+     *                  unchanged as long as the text is not read again
+     * \remarks When the text is read again, the digest of the read message
+     *          has to match the digest of the location.
+     */
+    void releaseMessage(const Location& location);
+
+
+    /** \brief Checks whether the text of the PM is in memory.
+     *
+     * \return Returns false, if the text has been released and not read again.
+     */
+    bool isMessageLoaded() const;
+
+
     /** \brief Calculates the SHA-256 hash of the PM.
      *
      * \return Returns SHA-256 hash of the PM.
@@ -105,6 +169,16 @@ class PrivateMessage
     const SHA256::MessageDigest& getHash();
 
 
+    /** \brief Sets the SHA-256 hash of the PM without calculating it.
+     *
+     * \param digest  the hash of the PM
+     * \remarks The caller has to make sure that the hash is correct, e.g.
+     *          because the PM was loaded from a file which has been verified
+     *          before. Any later change of the PM updates the hash as usual.
+     */
+    void setHash(const SHA256::MessageDigest& digest);
+
+
     /** \brief Sets new datestamp.
      *
      * \param ds  new value
@@ -116,7 +190,7 @@ class PrivateMessage
      *
      * \param t  the new title
      */
-    void setTitle(const std::string& t);
+    void setTitle(std::string t);
 
 
     /** \brief Sets new sender name.
@@ -144,7 +218,7 @@ class PrivateMessage
      *
      * \param msg  the new message text
      */
-    void setMessage(const std::string& msg);
+    void setMessage(std::string msg);
 
 
     /** \brief Determines the size of this PM, if it were saved to a file.
@@ -154,6 +228,16 @@ class PrivateMessage
     std::string::size_type getSaveSize() const;
 
 
+    /** \brief Serialises the message into a buffer.
+     *
+     * \param data  the string that will hold the serialised message
+     * \param compression   if set to Compression::zlib, the data will be compressed with zlib
+     * \return Returns true in case of success, or false if an error occurred.
+     * \remarks The buffer content is exactly what saveToFile() writes to a file.
+     */
+    bool saveToBuffer(std::string& data, const Compression compression) const;
+
+
     /** \brief Tries to save the message to the given file.
      *
      * \param fileName  the file that shall be used to save the message
@@ -168,10 +252,25 @@ class PrivateMessage
      * \param fileName file that shall be used to load the message
      * \param compression  Set this to Compression::zlib to indicate that the file contains a zlib-compressed PM.
      * \return Returns true in case of success, or false if an error occurred.
+     * \remarks The file is mapped into memory and parsed by loadFromBuffer().
      */
     bool loadFromFile(const std::string& fileName, const Compression compression);
 
 
+    /** \brief Tries to load the message from a buffer.
+     *
+     * \param data  pointer to the serialised message
+     * \param size  size of the buffer in bytes
+     * \param compression  Set this to Compression::zlib to indicate that the buffer contains a zlib-compressed PM.
+     * \return Returns true in case of success, or false if an error occurred.
+     * \remarks The buffer content has to be in the same format as the files
+     *          written by saveToFile(), e.g. as created by saveToBuffer().
+     *          Uncompressed data is parsed in place, without copying the
+     *          buffer first.
+     */
+    bool loadFromBuffer(const char* data, const std::size_t size, const Compression compression);
+
+
     /** \brief equality operator for PrivateMessage class
      *
      * \param other   the other PrivateMessage instance
@@ -200,23 +299,22 @@ class PrivateMessage
     bool saveToStream(std::ostream& outputStream) const;
 
 
-    /** \brief Tries to load the PM contents from an input stream.
+    /** \brief Reads the released message text from its file.
      *
-     * \param inputStream  stream that shall be used to load the PM;
-     *                     the stream shall be opened and ready for reading
-     *                     data from it when passed to the function.
-     * \return Returns true, if the data was loaded from the stream.
-     *         Returns false, if the read operation failed.
+     * \remarks Throws std::runtime_error, if the text cannot be read or if
+     *          the digest of the read message does not match the digest of
+     *          its location.
      */
-    bool loadFromStream(std::istream& inputStream);
+    void loadMessage() const;
 
 
-    std::string datestamp;  /**< date and time the PM was sent */
+    Datestamp datestamp;  /**< date and time the PM was sent */
     std::string title;  /**< title of the PM */
-    std::string fromUser;  /**< name of the sender */
+    const std::string* fromUser;  /**< name of the sender, in the string pool */
     uint32_t fromUserID;  /**< numeric ID of the sender */
-    std::string toUser;  /**< name of the recipients  */
-    std::string message;  /**< the message text */
+    const std::string* toUser;  /**< name of the recipients, in the string pool */
+    mutable std::string message;  /**< the message text */
+    mutable std::shared_ptr<const Location> m_Location;  /**< location of the released text, or nullptr */
     bool m_NeedsHashUpdate;  /**< tracks whether hash is not up to date */
     SHA256::MessageDigest m_Hash;  /**< hash of the message */
 }; // class
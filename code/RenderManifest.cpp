@@ -0,0 +1,158 @@
+/*
+ -------------------------------------------------------------------------------
+    This file is part of the Private Message Database.
+    Copyright (C) 2026  Dirk Stolle
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ -------------------------------------------------------------------------------
+*/
+
+#include "RenderManifest.hpp"
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include "sha256_backend.hpp"
+#include "../libstriezel/filesystem/directory.hpp"
+
+namespace pmdb::manifest
+{
+
+namespace
+{
+
+/// magic bytes at the start of the manifest file
+constexpr char manifestMagic[8] = { 'P', 'M', 'D', 'B', 'H', 'T', 'M', 'L' };
+
+/// current version of the manifest format
+constexpr std::uint32_t formatVersion = 1;
+
+/** \brief Appends a value to the serialised settings.
+ *
+ * \param data   the serialised settings
+ * \param value  the value to append
+ * \remarks Every string is preceded by its length, so that different
+ *          settings never result in the same serialisation.
+ */
+void append(std::string& data, const std::string& value)
+{
+  const std::uint64_t length = value.size();
+  data.append(reinterpret_cast<const char*>(&length), sizeof(length));
+  data.append(value);
+}
+
+void append(std::string& data, const bool value)
+{
+  data.push_back(value ? '\1' : '\0');
+}
+
+} // anonymous namespace
+
+SHA256::MessageDigest fingerprint(const std::string& messageTemplate, const HTMLOptions& htmlOptions,
+                                  const std::string& forumURL, const std::vector<Smilie>& smilies)
+{
+  std::string data;
+  data.append(reinterpret_cast<const char*>(&rendererVersion), sizeof(rendererVersion));
+  append(data, messageTemplate);
+  append(data, htmlOptions.standard == HTMLStandard::XHTML);
+  append(data, htmlOptions.nl2br);
+  append(data, htmlOptions.noList);
+  append(data, htmlOptions.tableClasses.useClasses);
+  append(data, htmlOptions.tableClasses.table);
+  append(data, htmlOptions.tableClasses.row);
+  append(data, htmlOptions.tableClasses.cell);
+  append(data, forumURL);
+  const std::uint64_t count = smilies.size();
+  data.append(reinterpret_cast<const char*>(&count), sizeof(count));
+  for (const Smilie& smilie: smilies)
+  {
+    append(data, smilie.code());
+    append(data, smilie.url());
+    append(data, smilie.type() == UrlType::Relative);
+  }
+  return pmdb::sha256::computeFromString(data);
+}
+
+bool readManifest(const std::string& directory, Manifest& manifest)
+{
+  manifest.digests.clear();
+  std::ifstream stream(libstriezel::filesystem::slashify(directory) + manifestFileName, std::ios_base::in | std::ios_base::binary);
+  if (!stream)
+  {
+    return false;
+  }
+  char magic[sizeof(manifestMagic)];
+  std::uint32_t version = 0;
+  std::uint64_t count = 0;
+  stream.read(magic, sizeof(magic));
+  stream.read(reinterpret_cast<char*>(&version), sizeof(version));
+  stream.read(reinterpret_cast<char*>(manifest.fingerprint.hash), sizeof(manifest.fingerprint.hash));
+  stream.read(reinterpret_cast<char*>(&count), sizeof(count));
+  if (!stream.good() || (std::memcmp(magic, manifestMagic, sizeof(manifestMagic)) != 0)
+      || (version != formatVersion))
+  {
+    return false;
+  }
+
+  for (std::uint64_t i = 0; i < count; ++i)
+  {
+    SHA256::MessageDigest digest;
+    if (!stream.read(reinterpret_cast<char*>(digest.hash), sizeof(digest.hash)))
+    {
+      manifest.digests.clear();
+      return false;
+    }
+    manifest.digests.emplace_hint(manifest.digests.end(), digest);
+  }
+  return true;
+}
+
+bool writeManifest(const std::string& directory, const Manifest& manifest)
+{
+  const std::string manifestPath = libstriezel::filesystem::slashify(directory) + manifestFileName;
+  const std::string tempPath = manifestPath + ".tmp";
+  std::ofstream stream(tempPath, std::ios_base::out | std::ios_base::binary | std::ios_base::trunc);
+  if (!stream)
+  {
+    return false;
+  }
+  const std::uint64_t count = manifest.digests.size();
+  stream.write(manifestMagic, sizeof(manifestMagic));
+  stream.write(reinterpret_cast<const char*>(&formatVersion), sizeof(formatVersion));
+  stream.write(reinterpret_cast<const char*>(manifest.fingerprint.hash), sizeof(manifest.fingerprint.hash));
+  stream.write(reinterpret_cast<const char*>(&count), sizeof(count));
+  for (const SHA256::MessageDigest& digest: manifest.digests)
+  {
+    stream.write(reinterpret_cast<const char*>(digest.hash), sizeof(digest.hash));
+  }
+  stream.close();
+  if (!stream.good())
+  {
+    std::error_code error;
+    std::filesystem::remove(tempPath, error);
+    return false;
+  }
+
+  std::error_code error;
+  std::filesystem::rename(tempPath, manifestPath, error);
+  return !error;
+}
+
+bool removeManifest(const std::string& directory)
+{
+  std::error_code error;
+  std::filesystem::remove(libstriezel::filesystem::slashify(directory) + manifestFileName, error);
+  return !error;
+}
+
+} // namespace
@@ -0,0 +1,102 @@
+/*
+ -------------------------------------------------------------------------------
+    This file is part of the Private Message Database.
+    Copyright (C) 2026  Dirk Stolle
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ -------------------------------------------------------------------------------
+*/
+
+#ifndef PMDB_RENDERMANIFEST_HPP
+#define PMDB_RENDERMANIFEST_HPP
+
+#include <cstdint>
+#include <set>
+#include <string>
+#include <vector>
+#include "HTMLOptions.hpp"
+#include "bbcode/Smilie.hpp"
+#include "../libstriezel/hash/sha256/sha256.hpp"
+
+/* The render manifest remembers which message files of the HTML directory
+   are up to date, so that they do not have to be created again every time
+   the HTML files are generated. The HTML file of a message only depends on
+   the message itself (whose digest is the file name) and on the settings
+   that were used to render it. Those settings are combined into a
+   fingerprint. The manifest is stored in the file render.manifest: a header
+   (magic bytes, format version, fingerprint) which is followed by the digests
+   of all messages whose files were created with that fingerprint.
+*/
+
+namespace pmdb::manifest
+{
+
+/// name of the manifest file within the HTML directory
+const std::string manifestFileName = "render.manifest";
+
+/** version of the HTML generation, has to be increased whenever a change of
+    the program changes the created HTML files */
+constexpr std::uint32_t rendererVersion = 1;
+
+/// content of a render manifest
+struct Manifest
+{
+  SHA256::MessageDigest fingerprint; /**< fingerprint of the render settings */
+  std::set<SHA256::MessageDigest> digests; /**< messages with up to date files */
+};
+
+
+/** \brief Calculates the fingerprint of the settings for HTML generation.
+ *
+ * \param messageTemplate  text of the template for message files
+ * \param htmlOptions      the options for HTML file generation
+ * \param forumURL         base URL of the forum
+ * \param smilies          the smilies that are used by the parser
+ * \return Returns the fingerprint of the settings.
+ */
+SHA256::MessageDigest fingerprint(const std::string& messageTemplate, const HTMLOptions& htmlOptions,
+                                  const std::string& forumURL, const std::vector<Smilie>& smilies);
+
+
+/** \brief Reads the render manifest of a directory.
+ *
+ * \param directory  the directory that contains the manifest
+ * \param manifest   will hold the content of the manifest
+ * \return Returns true in case of success, or false if there is no valid
+ *         manifest. The set of digests is empty in that case.
+ */
+bool readManifest(const std::string& directory, Manifest& manifest);
+
+
+/** \brief Writes the render manifest of a directory.
+ *
+ * \param directory  the directory that contains the HTML files
+ * \param manifest   the content of the manifest
+ * \return Returns true in case of success, or false if an error occurred.
+ * \remarks The manifest is written to a temporary file first, which then
+ *          replaces the existing manifest.
+ */
+bool writeManifest(const std::string& directory, const Manifest& manifest);
+
+
+/** \brief Removes the render manifest of a directory, if there is one.
+ *
+ * \param directory  the directory that contains the HTML files
+ * \return Returns true, if there is no manifest afterwards.
+ */
+bool removeManifest(const std::string& directory);
+
+} // namespace
+
+#endif // PMDB_RENDERMANIFEST_HPP
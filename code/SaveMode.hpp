@@ -0,0 +1,34 @@
+/*
+ -------------------------------------------------------------------------------
+    This file is part of the Private Message Database.
+    Copyright (C) 2026  Dirk Stolle
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ -------------------------------------------------------------------------------
+*/
+
+#ifndef PMDB_SAVEMODE_HPP
+#define PMDB_SAVEMODE_HPP
+
+/// enumeration for the ways messages can be saved to a directory
+enum class SaveMode: bool
+{
+  /// write every message in the database
+  Full = false,
+
+  /// write only messages that are not known to exist in the directory yet
+  Incremental = true
+};
+
+#endif // PMDB_SAVEMODE_HPP
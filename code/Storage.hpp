@@ -0,0 +1,34 @@
+/*
+ -------------------------------------------------------------------------------
+    This file is part of the Private Message Database.
+    Copyright (C) 2026  Dirk Stolle
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ -------------------------------------------------------------------------------
+*/
+
+#ifndef PMDB_STORAGE_HPP
+#define PMDB_STORAGE_HPP
+
+/// enumeration for the ways messages can be stored in a directory
+enum class Storage: bool
+{
+  /// one file per message, named after the message's hash
+  Directory = false,
+
+  /// all messages in a single pack file with an index (see MessagePack.hpp)
+  Pack = true
+};
+
+#endif // PMDB_STORAGE_HPP
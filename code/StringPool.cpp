@@ -0,0 +1,73 @@
+/*
+ -------------------------------------------------------------------------------
+    This file is part of the Private Message Database.
+    Copyright (C) 2026  Dirk Stolle
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ -------------------------------------------------------------------------------
+*/
+
+#include "StringPool.hpp"
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_set>
+
+namespace pmdb
+{
+
+namespace
+{
+
+/// the global string pool
+struct StringPool
+{
+  std::shared_mutex mutex; /**< guards strings */
+  std::unordered_set<std::string> strings; /**< pooled strings; nodes never move */
+};
+
+StringPool& pool()
+{
+  static StringPool instance;
+  return instance;
+}
+
+} // anonymous namespace
+
+const std::string& intern(const std::string_view str)
+{
+  static const std::string empty;
+  if (str.empty())
+  {
+    return empty;
+  }
+
+  // Lookups need a std::string, so the key buffer is reused per thread to
+  // avoid an allocation for every lookup of an already pooled string.
+  thread_local std::string key;
+  key.assign(str.data(), str.size());
+
+  StringPool& instance = pool();
+  {
+    std::shared_lock<std::shared_mutex> lock(instance.mutex);
+    const auto iter = instance.strings.find(key);
+    if (iter != instance.strings.end())
+    {
+      return *iter;
+    }
+  }
+  std::unique_lock<std::shared_mutex> lock(instance.mutex);
+  return *instance.strings.insert(key).first;
+}
+
+} // namespace
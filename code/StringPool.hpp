@@ -0,0 +1,44 @@
+/*
+ -------------------------------------------------------------------------------
+    This file is part of the Private Message Database.
+    Copyright (C) 2026  Dirk Stolle
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ -------------------------------------------------------------------------------
+*/
+
+#ifndef PMDB_STRINGPOOL_HPP
+#define PMDB_STRINGPOOL_HPP
+
+#include <string>
+#include <string_view>
+
+namespace pmdb
+{
+
+/** \brief Gets the pooled copy of a string.
+ *
+ * \param str  the string
+ * \return Returns a reference to the copy of str in the global string pool.
+ *         Equal strings always give the same reference, so pooled strings
+ *         can be compared by their address.
+ * \remarks Pooled strings are never freed, so the pool is meant for values
+ *          which occur many times, like user names. It may be used by
+ *          several threads at the same time.
+ */
+const std::string& intern(const std::string_view str);
+
+} // namespace
+
+#endif // PMDB_STRINGPOOL_HPP
@@ -0,0 +1,465 @@
+/*
+ -------------------------------------------------------------------------------
+    This file is part of the Private Message Database.
+    Copyright (C) 2026  Dirk Stolle
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ -------------------------------------------------------------------------------
+*/
+
+#include "TextContainment.hpp"
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include "parallel.hpp"
+
+namespace pmdb::containment
+{
+
+namespace
+{
+
+/** a group of identical texts */
+struct Group
+{
+  std::string_view text; /**< the text of all members of the group */
+  std::vector<std::size_t> members; /**< indices of the texts, ascending */
+};
+
+
+static_assert(gramLength == sizeof(uint64_t), "An n-gram has to fit into a 64 bit integer.");
+
+/** \brief Calculates the hash of the n-gram at the given position.
+ *
+ * \param data  pointer to the first character of the n-gram
+ * \return Returns the hash of the n-gram.
+ * \remarks The hash is a bijection of the n-gram, so different n-grams never
+ *          get the same hash.
+ */
+uint64_t gramHash(const char* data)
+{
+  uint64_t value;
+  std::memcpy(&value, data, sizeof(value));
+  // finalizer of splitmix64
+  value = (value ^ (value >> 30)) * UINT64_C(0xBF58476D1CE4E5B9);
+  value = (value ^ (value >> 27)) * UINT64_C(0x94D049BB133111EB);
+  return value ^ (value >> 31);
+}
+
+
+/** \brief Selects the fingerprints of a text by winnowing.
+ *
+ * \param text  the text, must be at least minimumFingerprintLength characters long
+ * \return Returns the sorted fingerprints of the text, without duplicates.
+ */
+std::vector<uint64_t> winnow(const std::string_view text)
+{
+  const std::size_t grams = text.size() - gramLength + 1;
+  std::vector<uint64_t> hashes(grams);
+  for (std::size_t i = 0; i < grams; ++i)
+  {
+    hashes[i] = gramHash(text.data() + i);
+  }
+
+  std::vector<uint64_t> fingerprints;
+  // positions of candidates for the window minimum, their hashes are increasing
+  std::deque<std::size_t> window;
+  for (std::size_t i = 0; i < grams; ++i)
+  {
+    while (!window.empty() && (hashes[window.back()] >= hashes[i]))
+    {
+      window.pop_back();
+    }
+    window.push_back(i);
+    if (window.front() + windowSize <= i)
+    {
+      window.pop_front();
+    }
+    if ((i + 1 >= windowSize)
+        && (fingerprints.empty() || (fingerprints.back() != hashes[window.front()])))
+    {
+      fingerprints.push_back(hashes[window.front()]);
+    }
+  }
+  std::sort(fingerprints.begin(), fingerprints.end());
+  fingerprints.erase(std::unique(fingerprints.begin(), fingerprints.end()), fingerprints.end());
+  return fingerprints;
+}
+
+
+/** \brief Removes duplicate entries from a vector and sorts it.
+ *
+ * \param vec  the vector
+ */
+void sortUnique(std::vector<std::size_t>& vec)
+{
+  std::sort(vec.begin(), vec.end());
+  vec.erase(std::unique(vec.begin(), vec.end()), vec.end());
+}
+
+
+/// number of groups that are processed as one work item by a thread
+constexpr std::size_t chunkSize = 256;
+
+/** \brief Calls a function for consecutive chunks of [0;count), using up to
+ *         jobs threads at the same time.
+ *
+ * \param count  the number of items
+ * \param jobs   the maximum number of threads to use
+ * \param func   function that takes the first and the one-past-last index of
+ *               a chunk
+ */
+template<typename Function>
+void forEachChunk(const std::size_t count, const unsigned int jobs, Function func)
+{
+  const std::size_t chunks = (count + chunkSize - 1) / chunkSize;
+  pmdb::parallel::forEachIndex(chunks, jobs, [&func, count](const std::size_t chunk)
+  {
+    const std::size_t first = chunk * chunkSize;
+    func(first, std::min(first + chunkSize, count));
+    return true;
+  });
+}
+
+
+/** Passes the progress of several threads to a ProgressFunction. */
+class ProgressReporter
+{
+  public:
+    /** \brief Constructor.
+     *
+     * \param func   the function that gets notified (may be empty)
+     * \param total  the total amount of work
+     */
+    ProgressReporter(const ProgressFunction& func, const std::size_t total)
+    : m_Function(func), m_Done(0), m_Total(total), m_Mutex()
+    {
+    }
+
+
+    /** \brief Adds work that is done and notifies the function.
+     *
+     * \param amount  the amount of work that was done
+     */
+    void advance(const std::size_t amount)
+    {
+      if (!m_Function)
+        return;
+      const std::lock_guard<std::mutex> guard(m_Mutex);
+      m_Done += amount;
+      m_Function(m_Done, m_Total);
+    }
+  private:
+    const ProgressFunction& m_Function;
+    std::size_t m_Done;
+    std::size_t m_Total;
+    std::mutex m_Mutex;
+}; // class
+
+
+/** \brief Finds groups with short texts that are contained in other groups.
+ *
+ * \param groups     the groups of identical texts
+ * \param contained  vector where the index of every short group is added to
+ *                   the element of each group that contains its text
+ * \param jobs       the maximum number of threads to use
+ * \param progress   reporter that gets one unit of work per group
+ */
+void findShortTexts(const std::vector<Group>& groups, std::vector<std::vector<std::size_t> >& contained, const unsigned int jobs, ProgressReporter& progress)
+{
+  std::unordered_map<std::string_view, std::size_t> shortGroups;
+  std::vector<std::size_t> lengths;
+  for (std::size_t g = 0; g < groups.size(); ++g)
+  {
+    if (groups[g].text.size() < minimumFingerprintLength)
+    {
+      shortGroups[groups[g].text] = g;
+      lengths.push_back(groups[g].text.size());
+    }
+  }
+  if (shortGroups.empty())
+  {
+    progress.advance(groups.size());
+    return;
+  }
+  sortUnique(lengths);
+
+  // Every thread only writes the elements of contained for its own chunk.
+  forEachChunk(groups.size(), jobs, [&](const std::size_t first, const std::size_t last)
+  {
+    for (std::size_t g = first; g < last; ++g)
+    {
+      const std::string_view text = groups[g].text;
+      for (const std::size_t length: lengths)
+      {
+        // Texts of the same length are either identical and thus in the same
+        // group, or they do not contain each other.
+        if (length >= text.size())
+          break;
+        const std::size_t lastPos = (length == 0) ? 0 : text.size() - length;
+        for (std::size_t pos = 0; pos <= lastPos; ++pos)
+        {
+          const auto iter = shortGroups.find(text.substr(pos, length));
+          if (iter != shortGroups.end())
+          {
+            contained[g].push_back(iter->second);
+          }
+        }
+      }
+      sortUnique(contained[g]);
+    }
+    progress.advance(last - first);
+  });
+}
+
+
+/** cheap summary of a long text that is used to reject candidates before the
+    full search with find() */
+struct Signature
+{
+  /** number of occurrences of the characters, grouped by the lower six bits
+      of the character and saturated at 255 */
+  std::array<uint8_t, 64> histogram;
+
+  /** bloom filter of the fingerprints of the text, size is a power of two */
+  std::vector<uint64_t> bloom;
+};
+
+
+/** \brief Gets the two bit positions of a fingerprint in a bloom filter.
+ *
+ * \param fp    the fingerprint
+ * \param bits  number of bits in the bloom filter, must be a power of two
+ * \return Returns the two bit positions.
+ */
+inline std::pair<std::size_t, std::size_t> bloomBits(const uint64_t fp, const std::size_t bits)
+{
+  return { static_cast<std::size_t>(fp) & (bits - 1),
+           static_cast<std::size_t>(fp >> 32) & (bits - 1) };
+}
+
+
+/** \brief Creates the signature of a text.
+ *
+ * \param text          the text
+ * \param fingerprints  the fingerprints of the text
+ * \return Returns the signature of the text.
+ */
+Signature makeSignature(const std::string_view text, const std::vector<uint64_t>& fingerprints)
+{
+  Signature sig;
+  sig.histogram.fill(0);
+  for (const char c: text)
+  {
+    uint8_t& count = sig.histogram[static_cast<unsigned char>(c) & 63];
+    if (count < 255)
+      ++count;
+  }
+
+  // about eight bits per fingerprint keep false positives at a few percent
+  std::size_t bits = 64;
+  while (bits < 8 * fingerprints.size())
+  {
+    bits *= 2;
+  }
+  sig.bloom.assign(bits / 64, 0);
+  for (const uint64_t fp: fingerprints)
+  {
+    const auto [first, second] = bloomBits(fp, bits);
+    sig.bloom[first / 64] |= UINT64_C(1) << (first % 64);
+    sig.bloom[second / 64] |= UINT64_C(1) << (second % 64);
+  }
+  return sig;
+}
+
+
+/** \brief Checks cheaply whether a text may contain another text.
+ *
+ * \param haystack        signature of the possibly containing text
+ * \param needle          signature of the possibly contained text
+ * \param needlePrints    fingerprints of the possibly contained text
+ * \return Returns false, if the haystack cannot contain the needle.
+ *         Returns true, if it may contain the needle.
+ */
+bool mayContain(const Signature& haystack, const Signature& needle, const std::vector<uint64_t>& needlePrints)
+{
+  // A saturated count in the haystack is at least 255, so it is never less
+  // than the (saturated) count of the needle.
+  for (std::size_t i = 0; i < haystack.histogram.size(); ++i)
+  {
+    if (needle.histogram[i] > haystack.histogram[i])
+      return false;
+  }
+
+  const std::size_t bits = haystack.bloom.size() * 64;
+  for (const uint64_t fp: needlePrints)
+  {
+    const auto [first, second] = bloomBits(fp, bits);
+    if (((haystack.bloom[first / 64] & (UINT64_C(1) << (first % 64))) == 0)
+        || ((haystack.bloom[second / 64] & (UINT64_C(1) << (second % 64))) == 0))
+      return false;
+  }
+  return true;
+}
+
+
+/** \brief Finds groups with long texts that are contained in other groups.
+ *
+ * \param groups     the groups of identical texts, sorted by text length
+ * \param contained  vector where the index of every long group is added to
+ *                   the element of each group that contains its text
+ * \param jobs       the maximum number of threads to use
+ * \param progress   reporter that gets one unit of work per group
+ */
+void findLongTexts(const std::vector<Group>& groups, std::vector<std::vector<std::size_t> >& contained, const unsigned int jobs, ProgressReporter& progress)
+{
+  std::vector<std::vector<uint64_t> > fingerprints(groups.size());
+  std::vector<Signature> signatures(groups.size());
+  forEachChunk(groups.size(), jobs, [&](const std::size_t first, const std::size_t last)
+  {
+    for (std::size_t g = first; g < last; ++g)
+    {
+      if (groups[g].text.size() >= minimumFingerprintLength)
+      {
+        fingerprints[g] = winnow(groups[g].text);
+        signatures[g] = makeSignature(groups[g].text, fingerprints[g]);
+      }
+    }
+  });
+
+  // Groups are sorted by length, so every list of postings is sorted by the
+  // text length, too.
+  std::unordered_map<uint64_t, std::vector<std::size_t> > postings;
+  for (std::size_t g = 0; g < groups.size(); ++g)
+  {
+    for (const uint64_t fp: fingerprints[g])
+    {
+      postings[fp].push_back(g);
+    }
+  }
+
+  // containers[b] holds the groups whose text contains the text of b.
+  std::vector<std::vector<std::size_t> > containers(groups.size());
+  forEachChunk(groups.size(), jobs, [&](const std::size_t first, const std::size_t last)
+  {
+    for (std::size_t b = first; b < last; ++b)
+    {
+      if (fingerprints[b].empty())
+        continue;
+      // Every text containing the text of b has all fingerprints of b, so the
+      // texts with the rarest fingerprint of b are the only candidates.
+      const std::vector<std::size_t>* candidates = nullptr;
+      for (const uint64_t fp: fingerprints[b])
+      {
+        const std::vector<std::size_t>& list = postings.find(fp)->second;
+        if ((candidates == nullptr) || (list.size() < candidates->size()))
+        {
+          candidates = &list;
+          if (list.size() == 1)
+            break;
+        }
+      }
+
+      // Only longer texts can contain the text of b.
+      const std::string_view text = groups[b].text;
+      auto iter = std::upper_bound(candidates->begin(), candidates->end(), text.size(),
+          [&groups](const std::size_t length, const std::size_t g)
+          {
+            return length < groups[g].text.size();
+          });
+      for ( ; iter != candidates->end(); ++iter)
+      {
+        const std::size_t a = *iter;
+        if (mayContain(signatures[a], signatures[b], fingerprints[b])
+            && (groups[a].text.find(text) != std::string_view::npos))
+        {
+          containers[b].push_back(a);
+        }
+      }
+    }
+    progress.advance(last - first);
+  });
+
+  for (std::size_t b = 0; b < groups.size(); ++b)
+  {
+    for (const std::size_t a: containers[b])
+    {
+      contained[a].push_back(b);
+    }
+  }
+}
+
+} // anonymous namespace
+
+
+std::vector<std::vector<std::size_t> > findContainedTexts(const std::vector<std::string_view>& texts, const unsigned int jobs, const ProgressFunction& progress)
+{
+  std::vector<Group> groups;
+  {
+    std::unordered_map<std::string_view, std::size_t> groupOfText;
+    groupOfText.reserve(texts.size());
+    for (std::size_t i = 0; i < texts.size(); ++i)
+    {
+      const auto [iter, inserted] = groupOfText.try_emplace(texts[i], groups.size());
+      if (inserted)
+      {
+        groups.push_back(Group{texts[i], {}});
+      }
+      groups[iter->second].members.push_back(i);
+    }
+  }
+  std::stable_sort(groups.begin(), groups.end(), [](const Group& a, const Group& b)
+  {
+    return a.text.size() < b.text.size();
+  });
+
+  // contained[g] holds the groups whose text is contained in the text of g.
+  std::vector<std::vector<std::size_t> > contained(groups.size());
+  ProgressReporter reporter(progress, 2 * groups.size());
+  findShortTexts(groups, contained, jobs, reporter);
+  findLongTexts(groups, contained, jobs, reporter);
+
+  std::vector<std::vector<std::size_t> > result(texts.size());
+  for (std::size_t g = 0; g < groups.size(); ++g)
+  {
+    if (contained[g].empty() && (groups[g].members.size() == 1))
+      continue;
+    sortUnique(contained[g]);
+    // Identical texts contain each other, too.
+    std::vector<std::size_t> indices = groups[g].members;
+    for (const std::size_t other: contained[g])
+    {
+      indices.insert(indices.end(), groups[other].members.begin(), groups[other].members.end());
+    }
+    std::sort(indices.begin(), indices.end());
+    for (const std::size_t member: groups[g].members)
+    {
+      std::vector<std::size_t>& list = result[member];
+      list.reserve(indices.size() - 1);
+      for (const std::size_t idx: indices)
+      {
+        if (idx != member)
+          list.push_back(idx);
+      }
+    }
+  }
+  return result;
+}
+
+} // namespace
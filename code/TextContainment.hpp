@@ -0,0 +1,84 @@
+/*
+ -------------------------------------------------------------------------------
+    This file is part of the Private Message Database.
+    Copyright (C) 2026  Dirk Stolle
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ -------------------------------------------------------------------------------
+*/
+
+#ifndef PMDB_TEXTCONTAINMENT_HPP
+#define PMDB_TEXTCONTAINMENT_HPP
+
+#include <cstddef>
+#include <functional>
+#include <string_view>
+#include <vector>
+
+namespace pmdb::containment
+{
+
+/// length of the character n-grams that are used as fingerprints
+constexpr std::size_t gramLength = 8;
+
+/// number of consecutive n-grams from which one fingerprint is selected
+constexpr std::size_t windowSize = 8;
+
+/** minimum text length for which fingerprints are used; shorter texts are
+    looked up directly among the substrings of the other texts */
+constexpr std::size_t minimumFingerprintLength = gramLength + windowSize - 1;
+
+
+/** Type of a function that is notified about the progress of the search. It
+    gets the amount of work that is done and the total amount of work. */
+using ProgressFunction = std::function<void(std::size_t done, std::size_t total)>;
+
+
+/** \brief Finds all texts that are contained in other texts.
+ *
+ * \param texts     the texts to search
+ * \param jobs      the maximum number of threads to use
+ * \param progress  function that is notified about the progress (may be empty)
+ * \return Returns a vector with one element per text. The element at index i
+ *         contains the indices of all other texts j (j != i) for which
+ *         texts[j] is a substring of texts[i], in ascending order.
+ * \remarks The result is the same as comparing every text against every other
+ *          text with std::string_view::find(), but the work is roughly linear
+ *          in the total length of all texts:
+ *          - Identical texts are grouped, so every distinct text is handled
+ *            only once.
+ *          - Texts shorter than minimumFingerprintLength are put into a hash
+ *            table, and every substring of matching length of the other texts
+ *            is looked up in that table.
+ *          - For the remaining texts a set of fingerprints is selected by
+ *            winnowing (the minimum n-gram hash of every window of windowSize
+ *            consecutive n-grams). A text that contains another text selects
+ *            all fingerprints of the contained text, too. So only the texts
+ *            which share the rarest fingerprint of a text are candidates, and
+ *            just those are verified with std::string_view::find().
+ *          - Texts are sorted by length, so candidates which are not longer
+ *            than the contained text are skipped right away. Before find() is
+ *            called, a histogram of the characters and a bloom filter of the
+ *            fingerprints of both texts are compared to reject most of the
+ *            remaining false candidates.
+ *          The searches for the containing texts are split into chunks of
+ *          texts that are processed by up to jobs threads. The progress
+ *          function is never called by more than one thread at the same time,
+ *          and the last call has done == total.
+ */
+std::vector<std::vector<std::size_t> > findContainedTexts(const std::vector<std::string_view>& texts, const unsigned int jobs = 1, const ProgressFunction& progress = nullptr);
+
+} // namespace
+
+#endif // PMDB_TEXTCONTAINMENT_HPP
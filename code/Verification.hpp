@@ -0,0 +1,37 @@
+/*
+ -------------------------------------------------------------------------------
+    This file is part of the Private Message Database.
+    Copyright (C) 2026  Dirk Stolle
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ -------------------------------------------------------------------------------
+*/
+
+#ifndef PMDB_VERIFICATION_HPP
+#define PMDB_VERIFICATION_HPP
+
+/// enumeration for the ways loaded messages are checked against their hashes
+enum class Verification
+{
+  /// trust the stored hashes, no message is hashed
+  None,
+
+  /// hash only every n-th message that has not been verified before
+  Sample,
+
+  /// hash every message that has not been verified before
+  Full
+};
+
+#endif // PMDB_VERIFICATION_HPP
@@ -0,0 +1,150 @@
+/*
+ -------------------------------------------------------------------------------
+    This file is part of the Private Message Database.
+    Copyright (C) 2026  Dirk Stolle
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ -------------------------------------------------------------------------------
+*/
+
+#include "VerificationCache.hpp"
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include "../libstriezel/filesystem/directory.hpp"
+
+namespace pmdb::verification
+{
+
+namespace
+{
+
+/// magic bytes at the start of the cache file
+constexpr char cacheMagic[8] = { 'P', 'M', 'D', 'B', 'V', 'R', 'F', 'Y' };
+
+/// current version of the cache format
+constexpr std::uint32_t formatVersion = 1;
+
+/// size of a single entry in the cache file in bytes
+constexpr std::size_t entrySize = sizeof(SHA256::MessageDigest::hash) + sizeof(std::uint64_t) + sizeof(std::int64_t);
+
+} // anonymous namespace
+
+bool FileState::operator==(const FileState& other) const
+{
+  return (size == other.size) && (modified == other.modified);
+}
+
+bool FileState::operator!=(const FileState& other) const
+{
+  return !(*this == other);
+}
+
+bool getFileState(const std::string& path, FileState& state)
+{
+  std::error_code error;
+  const auto size = std::filesystem::file_size(path, error);
+  if (error)
+  {
+    return false;
+  }
+  const auto modified = std::filesystem::last_write_time(path, error);
+  if (error)
+  {
+    return false;
+  }
+  state.size = size;
+  state.modified = static_cast<std::int64_t>(modified.time_since_epoch().count());
+  return true;
+}
+
+bool readCache(const std::string& directory, const Compression compression, Cache& cache)
+{
+  cache.clear();
+  std::ifstream stream(libstriezel::filesystem::slashify(directory) + cacheFileName, std::ios_base::in | std::ios_base::binary);
+  if (!stream)
+  {
+    return false;
+  }
+  char magic[sizeof(cacheMagic)];
+  std::uint32_t version = 0;
+  std::uint32_t compressionValue = 0;
+  std::uint64_t count = 0;
+  stream.read(magic, sizeof(magic));
+  stream.read(reinterpret_cast<char*>(&version), sizeof(version));
+  stream.read(reinterpret_cast<char*>(&compressionValue), sizeof(compressionValue));
+  stream.read(reinterpret_cast<char*>(&count), sizeof(count));
+  const std::uint32_t expectedCompression = (compression == Compression::zlib) ? 1 : 0;
+  if (!stream.good() || (std::memcmp(magic, cacheMagic, sizeof(cacheMagic)) != 0)
+      || (version != formatVersion) || (compressionValue != expectedCompression))
+  {
+    return false;
+  }
+
+  std::string buffer(entrySize, '\0');
+  for (std::uint64_t i = 0; i < count; ++i)
+  {
+    if (!stream.read(buffer.data(), entrySize))
+    {
+      cache.clear();
+      return false;
+    }
+    SHA256::MessageDigest digest;
+    FileState state;
+    const char* ptr = buffer.c_str();
+    std::memcpy(digest.hash, ptr, sizeof(digest.hash));
+    ptr += sizeof(digest.hash);
+    std::memcpy(&state.size, ptr, sizeof(state.size));
+    ptr += sizeof(state.size);
+    std::memcpy(&state.modified, ptr, sizeof(state.modified));
+    cache.emplace_hint(cache.end(), digest, state);
+  }
+  return true;
+}
+
+bool writeCache(const std::string& directory, const Compression compression, const Cache& cache)
+{
+  const std::string cachePath = libstriezel::filesystem::slashify(directory) + cacheFileName;
+  const std::string tempPath = cachePath + ".tmp";
+  std::ofstream stream(tempPath, std::ios_base::out | std::ios_base::binary | std::ios_base::trunc);
+  if (!stream)
+  {
+    return false;
+  }
+  const std::uint32_t compressionValue = (compression == Compression::zlib) ? 1 : 0;
+  const std::uint64_t count = cache.size();
+  stream.write(cacheMagic, sizeof(cacheMagic));
+  stream.write(reinterpret_cast<const char*>(&formatVersion), sizeof(formatVersion));
+  stream.write(reinterpret_cast<const char*>(&compressionValue), sizeof(compressionValue));
+  stream.write(reinterpret_cast<const char*>(&count), sizeof(count));
+  for (const auto& [digest, state]: cache)
+  {
+    stream.write(reinterpret_cast<const char*>(digest.hash), sizeof(digest.hash));
+    stream.write(reinterpret_cast<const char*>(&state.size), sizeof(state.size));
+    stream.write(reinterpret_cast<const char*>(&state.modified), sizeof(state.modified));
+  }
+  stream.close();
+  if (!stream.good())
+  {
+    std::error_code error;
+    std::filesystem::remove(tempPath, error);
+    return false;
+  }
+
+  std::error_code error;
+  std::filesystem::rename(tempPath, cachePath, error);
+  return !error;
+}
+
+} // namespace
@@ -0,0 +1,96 @@
+/*
+ -------------------------------------------------------------------------------
+    This file is part of the Private Message Database.
+    Copyright (C) 2026  Dirk Stolle
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ -------------------------------------------------------------------------------
+*/
+
+#ifndef PMDB_VERIFICATIONCACHE_HPP
+#define PMDB_VERIFICATIONCACHE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include "Compression.hpp"
+#include "../libstriezel/hash/sha256/sha256.hpp"
+
+/* The verification cache remembers which message files of a directory have
+   been hashed successfully, so that unchanged files do not have to be hashed
+   again every time the directory is loaded. It is stored in the file
+   verified.cache: a header (magic bytes, format version, compression) which
+   is followed by one entry per file, sorted by digest. An entry contains the
+   digest (i. e. the file name) and the size and modification time the file
+   had when it was verified.
+*/
+
+namespace pmdb::verification
+{
+
+/// name of the cache file within a message directory
+const std::string cacheFileName = "verified.cache";
+
+/// with Verification::Sample, only every sampleInterval-th message is hashed
+constexpr std::size_t sampleInterval = 16;
+
+/// size and modification time of a file
+struct FileState
+{
+  std::uint64_t size;    /**< size of the file in bytes */
+  std::int64_t modified; /**< time of last modification, in file clock ticks */
+
+  bool operator==(const FileState& other) const;
+  bool operator!=(const FileState& other) const;
+};
+
+/// verified files of a directory, mapped by their digest
+typedef std::map<SHA256::MessageDigest, FileState> Cache;
+
+
+/** \brief Gets the size and modification time of a file.
+ *
+ * \param path   path of the file
+ * \param state  will hold the size and modification time of the file
+ * \return Returns true in case of success, or false if an error occurred.
+ */
+bool getFileState(const std::string& path, FileState& state);
+
+
+/** \brief Reads the verification cache of a directory.
+ *
+ * \param directory    the directory that contains the cache
+ * \param compression  compression of the message files that are loaded
+ * \param cache        will hold the cache entries
+ * \return Returns true in case of success, or false if there is no valid
+ *         cache for the given compression. The cache is empty in that case.
+ */
+bool readCache(const std::string& directory, const Compression compression, Cache& cache);
+
+
+/** \brief Writes the verification cache of a directory.
+ *
+ * \param directory    the directory that contains the message files
+ * \param compression  compression of the message files
+ * \param cache        the cache entries
+ * \return Returns true in case of success, or false if an error occurred.
+ * \remarks The cache is written to a temporary file first, which then
+ *          replaces the existing cache.
+ */
+bool writeCache(const std::string& directory, const Compression compression, const Cache& cache);
+
+} // namespace
+
+#endif // PMDB_VERIFICATIONCACHE_HPP
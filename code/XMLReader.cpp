@@ -0,0 +1,107 @@
+/*
+ -------------------------------------------------------------------------------
+    This file is part of the Private Message Database.
+    Copyright (C) 2026  Dirk Stolle
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ -------------------------------------------------------------------------------
+*/
+
+#include "XMLReader.hpp"
+
+XMLReader::XMLReader(const std::string& fileName)
+: m_Reader(xmlReaderForFile(fileName.c_str(), nullptr, 0)),
+  m_Error(m_Reader == nullptr)
+{
+}
+
+XMLReader::~XMLReader()
+{
+  if (m_Reader != nullptr)
+  {
+    xmlFreeTextReader(m_Reader);
+    m_Reader = nullptr;
+  }
+}
+
+bool XMLReader::isOpen() const
+{
+  return m_Reader != nullptr;
+}
+
+bool XMLReader::read()
+{
+  if (m_Error)
+    return false;
+  const int ret = xmlTextReaderRead(m_Reader);
+  if (ret < 0)
+  {
+    m_Error = true;
+  }
+  return ret == 1;
+}
+
+bool XMLReader::hasError() const
+{
+  return m_Error;
+}
+
+int XMLReader::getNodeType() const
+{
+  return xmlTextReaderNodeType(m_Reader);
+}
+
+std::string XMLReader::getName() const
+{
+  const xmlChar* name = xmlTextReaderConstLocalName(m_Reader);
+  if (name == nullptr)
+    return "";
+  return reinterpret_cast<const char*>(name);
+}
+
+int XMLReader::getDepth() const
+{
+  return xmlTextReaderDepth(m_Reader);
+}
+
+bool XMLReader::isEmptyElement() const
+{
+  return xmlTextReaderIsEmptyElement(m_Reader) == 1;
+}
+
+std::string XMLReader::getValue() const
+{
+  const xmlChar* value = xmlTextReaderConstValue(m_Reader);
+  if (value == nullptr)
+    return "";
+  return reinterpret_cast<const char*>(value);
+}
+
+void XMLReader::appendValue(std::string& text) const
+{
+  const xmlChar* value = xmlTextReaderConstValue(m_Reader);
+  if (value != nullptr)
+    text.append(reinterpret_cast<const char*>(value));
+}
+
+std::string XMLReader::getAttribute(const std::string& name) const
+{
+  xmlChar* value = xmlTextReaderGetAttribute(m_Reader, reinterpret_cast<const xmlChar*>(name.c_str()));
+  if (value == nullptr)
+    return "";
+  std::string result = reinterpret_cast<const char*>(value);
+  // Free it, because xmlTextReaderGetAttribute() allocated memory.
+  xmlFree(value);
+  return result;
+}
@@ -0,0 +1,107 @@
+/*
+ -------------------------------------------------------------------------------
+    This file is part of the Private Message Database.
+    Copyright (C) 2026  Dirk Stolle
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ -------------------------------------------------------------------------------
+*/
+
+#ifndef XMLREADER_HPP
+#define XMLREADER_HPP
+
+#include <string>
+#include <libxml/xmlreader.h>
+
+/** \brief This is a C++-style wrapper class for libxml(2)'s xmlTextReader type.
+ *
+ * \remarks The reader walks through an XML file node by node without building
+ *          the whole document tree, so only the current node is in memory.
+ */
+class XMLReader
+{
+  public:
+    /** \brief constructor
+     *
+     * \param fileName   path to the XML file that shall be read
+     */
+    XMLReader(const std::string& fileName);
+
+
+    XMLReader(const XMLReader& op) = delete;
+    XMLReader& operator=(const XMLReader& op) = delete;
+
+
+    ~XMLReader();
+
+
+    /** Returns true, if the file could be opened for reading. */
+    bool isOpen() const;
+
+
+    /** \brief Moves the reader to the next node in document order.
+     *
+     * \return Returns true, if the next node was read.
+     *         Returns false, if the end of the document was reached or if an
+     *         error occurred. Use hasError() to distinguish between both.
+     */
+    bool read();
+
+
+    /** Returns true, if the reader encountered an error, e.g. because the
+        document is not well-formed. */
+    bool hasError() const;
+
+
+    /** \brief Gets the type of the current node.
+     *
+     * \return Returns the type of the current node as xmlReaderTypes value.
+     */
+    int getNodeType() const;
+
+
+    /** returns the local name of the current node as an STL string */
+    std::string getName() const;
+
+
+    /** returns the depth of the current node, the root element has depth 0 */
+    int getDepth() const;
+
+
+    /** returns true, if the current node is an empty element like <a/> */
+    bool isEmptyElement() const;
+
+
+    /** returns the text value of the current node, e.g. for text nodes */
+    std::string getValue() const;
+
+
+    /** appends the text value of the current node to text, without creating
+        a temporary string first */
+    void appendValue(std::string& text) const;
+
+
+    /** \brief Gets the value of an attribute of the current element.
+     *
+     * \param name  name of the attribute
+     * \return Returns the value of the attribute.
+     *         Returns an empty string, if there is no such attribute.
+     */
+    std::string getAttribute(const std::string& name) const;
+  private:
+    xmlTextReaderPtr m_Reader;
+    bool m_Error;
+}; // class
+
+#endif // XMLREADER_HPP
@@ -1,7 +1,7 @@
 /*
  -------------------------------------------------------------------------------
     This file is part of the Private Message Database.
-    Copyright (C) 2012, 2013, 2014  Dirk Stolle
+    Copyright (C) 2012, 2013, 2014, 2026  Dirk Stolle
 
     This program is free software: you can redistribute it and/or modify
     it under the terms of the GNU General Public License as published by
@@ -51,9 +51,30 @@ struct BBCode
      * into its (X)HTML representation.
      *
      * \param text   the message text that (may) contain the BB code
+     * \remarks Implementations have to leave the text unchanged, if it does not
+     * contain both "[name" and "[/name" (ignoring case). BBCodeParser skips
+     * codes for such texts.
      */
     virtual void applyToText(std::string& text) const = 0;
 
+
+    /** \brief Gets the fixed replacements for the opening and the closing tag,
+     * if the code just replaces "[name]" and "[/name]" the way SimpleBBCode
+     * does it.
+     *
+     * \param before   will hold the replacement for the opening tag
+     * \param after    will hold the replacement for the closing tag
+     * \return Returns true, if the code can be handled that way. The default
+     *         implementation returns false.
+     * \remarks Derived classes that change applyToText() have to return false.
+     */
+    virtual bool getTagReplacements(std::string& before, std::string& after) const
+    {
+      (void) before;
+      (void) after;
+      return false;
+    }
+
     #ifndef NO_BBCODE_NOTIFY
     template<typename notifier>
     void notify(const std::string& msg) const
@@ -1,7 +1,7 @@
 /*
  -------------------------------------------------------------------------------
     This file is part of the Private Message Database.
-    Copyright (C) 2012, 2013, 2025  Dirk Stolle
+    Copyright (C) 2012, 2013, 2025, 2026  Dirk Stolle
 
     This program is free software: you can redistribute it and/or modify
     it under the terms of the GNU General Public License as published by
@@ -19,6 +19,7 @@
 */
 
 #include "BBCodeParser.hpp"
+#include <algorithm>
 #include "quotes.hpp"
 
 BBCodeParser::BBCodeParser()
@@ -28,11 +29,13 @@ BBCodeParser::BBCodeParser()
   #endif
   #ifndef NO_SMILIES_IN_PARSER
   m_Smilies(std::vector<Smilie>()),
+  m_SmilieTriggers(std::vector<std::size_t>()),
   #endif
   #ifndef NO_POSTPROCESSORS_IN_PARSER
   m_PostProcs(std::vector<TextProcessor*>()),
   #endif
-  m_Codes(std::vector<const BBCode*>())
+  m_Codes(std::vector<CodePass>()),
+  m_Scanner(PatternScanner())
 {
 }
 
@@ -49,26 +52,59 @@ std::string BBCodeParser::parse(std::string text, const std::string& forumURL, c
   // handle line breaks
   if (nl2br)
   {
-    std::string::size_type pos = text.find("\n");
-    const bool isXHTML = standard == HTMLStandard::XHTML;
-    while (pos != std::string::npos)
+    const std::string lineBreak = (standard == HTMLStandard::XHTML) ? "<br />\n" : "<br>\n";
+    std::string::size_type pos = text.find('\n');
+    if (pos != std::string::npos)
     {
-      text.replace(pos, 1, isXHTML ? "<br />\n" : "<br>\n");
-      pos = text.find("\n", isXHTML ? pos + 7 : pos + 5);
+      std::string withBreaks;
+      withBreaks.reserve(text.length() + std::count(text.begin() + pos, text.end(), '\n') * (lineBreak.length() - 1));
+      std::string::size_type copied = 0;
+      while (pos != std::string::npos)
+      {
+        withBreaks.append(text, copied, pos - copied);
+        withBreaks.append(lineBreak);
+        copied = pos + 1;
+        pos = text.find('\n', copied);
+      }
+      withBreaks.append(text, copied, std::string::npos);
+      text.swap(withBreaks);
     }
   } // if
 
   // handle bb codes
-  for (const BBCode* code: m_Codes)
+  std::vector<bool> found;
+  bool needsScan = true;
+  for (const CodePass& pass: m_Codes)
   {
-    code->applyToText(text);
+    // Output of a code may contain tags of later codes, so the text has to
+    // be scanned again after a code was applied.
+    if (needsScan)
+    {
+      m_Scanner.scan(text, found);
+      needsScan = false;
+    }
+    if (!isTriggered(pass, found))
+      continue;
+    if (pass.code != nullptr)
+      pass.code->applyToText(text);
+    else
+      pass.simpleCodes.applyToText(text);
+    needsScan = true;
   }
 
   #ifndef NO_SMILIES_IN_PARSER
   // handle smilies
-  for (const auto& sm: m_Smilies)
+  for (std::size_t idx = 0; idx < m_Smilies.size(); ++idx)
   {
-    sm.applyToText(text, forumURL, standard);
+    if (needsScan)
+    {
+      m_Scanner.scan(text, found);
+      needsScan = false;
+    }
+    if (!found[m_SmilieTriggers[idx]])
+      continue;
+    m_Smilies[idx].applyToText(text, forumURL, standard);
+    needsScan = true;
   }
   #endif
 
@@ -96,14 +132,39 @@ void BBCodeParser::addPreProcessor(TextProcessor* preProc)
 
 void BBCodeParser::addCode(const BBCode* code)
 {
-  if (code != nullptr)
-    m_Codes.push_back(code);
+  if (code == nullptr)
+    return;
+  const std::pair<std::size_t, std::size_t> trigger(m_Scanner.add("[" + code->getName()),
+                                                    m_Scanner.add("[/" + code->getName()));
+  // Codes with fixed replacements are collected, as long as there is no other
+  // code in between that could depend on the order.
+  if (!m_Codes.empty() && (m_Codes.back().code == nullptr)
+      && m_Codes.back().simpleCodes.add(*code))
+  {
+    m_Codes.back().triggers.push_back(trigger);
+    return;
+  }
+  CodePass pass{ nullptr, SimpleTagReplacer(), { trigger } };
+  if (!pass.simpleCodes.add(*code))
+    pass.code = code;
+  m_Codes.push_back(std::move(pass));
+}
+
+bool BBCodeParser::isTriggered(const CodePass& pass, const std::vector<bool>& found)
+{
+  for (const auto& [open, close] : pass.triggers)
+  {
+    if (found[open] && found[close])
+      return true;
+  }
+  return false;
 }
 
 #ifndef NO_SMILIES_IN_PARSER
 void BBCodeParser::addSmilie(const Smilie& sm)
 {
   m_Smilies.push_back(sm);
+  m_SmilieTriggers.push_back(m_Scanner.add(sm.code()));
 }
 #endif
 
@@ -1,7 +1,7 @@
 /*
  -------------------------------------------------------------------------------
     This file is part of the Private Message Database.
-    Copyright (C) 2012, 2013, 2014, 2025  Dirk Stolle
+    Copyright (C) 2012, 2013, 2014, 2025, 2026  Dirk Stolle
 
     This program is free software: you can redistribute it and/or modify
     it under the terms of the GNU General Public License as published by
@@ -36,6 +36,8 @@
 #include <string>
 #include <vector>
 #include "BBCode.hpp"
+#include "PatternScanner.hpp"
+#include "SimpleTagReplacer.hpp"
 #include "../HTMLStandard.hpp"
 #ifndef NO_SMILIES_IN_PARSER
   #include "Smilie.hpp"
@@ -107,6 +109,14 @@ class BBCodeParser
            old codes in between will not do any harm, it just causes this codes
            to be applied twice - although the second pass should not find any
            codes to replace, because the first one already took care of that.
+
+           Consecutive codes that just replace their opening and closing tags
+           by fixed HTML code (see BBCode::getTagReplacements()) are handled
+           together by a SimpleTagReplacer in a single pass over the text.
+
+           Before the codes are applied, a single scan over the text finds out
+           which tags occur at all, and codes whose tags do not occur are
+           skipped. The text is only scanned again after a code was applied.
     */
     void addCode(const BBCode* code);
 
@@ -160,16 +170,36 @@ class BBCodeParser
     }
     #endif
   private:
+    /// step of the BB code handling
+    struct CodePass
+    {
+      const BBCode* code; /**< code that is applied on its own, or nullptr */
+      SimpleTagReplacer simpleCodes; /**< codes that are applied together, if code is nullptr */
+      std::vector<std::pair<std::size_t, std::size_t> > triggers; /**< indices of "[name" and "[/name" in m_Scanner for every code of the step */
+    };
+
+
+    /** \brief Checks whether a step has to be applied to a text.
+     *
+     * \param pass    the step
+     * \param found   result of m_Scanner.scan() for the text
+     * \return Returns true, if the opening and closing tag of at least one of
+     *         the codes of the step occur in the text.
+     */
+    static bool isTriggered(const CodePass& pass, const std::vector<bool>& found);
+
     #ifndef NO_PREPROCESSORS_IN_PARSER
     std::vector<TextProcessor*> m_PreProcs;
     #endif
     #ifndef NO_SMILIES_IN_PARSER
     std::vector<Smilie>  m_Smilies;
+    std::vector<std::size_t> m_SmilieTriggers; /**< indices of the smilie codes in m_Scanner */
     #endif
     #ifndef NO_POSTPROCESSORS_IN_PARSER
     std::vector<TextProcessor*> m_PostProcs;
     #endif
-    std::vector<const BBCode*> m_Codes;
+    std::vector<CodePass> m_Codes; /**< BB code handling steps in order of addition */
+    PatternScanner m_Scanner; /**< finds the tags and smilie codes that occur in a text */
 }; // class
 
 #endif // BBCODEPARSER_HPP
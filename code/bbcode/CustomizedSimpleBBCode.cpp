@@ -1,7 +1,7 @@
 /*
  -------------------------------------------------------------------------------
     This file is part of the Private Message Database.
-    Copyright (C) 2012, 2015, 2016  Dirk Stolle
+    Copyright (C) 2012, 2015, 2016, 2026  Dirk Stolle
 
     This program is free software: you can redistribute it and/or modify
     it under the terms of the GNU General Public License as published by
@@ -42,3 +42,10 @@ void CustomizedSimpleBBCode::applyToText(std::string& text) const
     pos = find_ci(text, code, pos);
   }
 }
+
+bool CustomizedSimpleBBCode::getTagReplacements(std::string& before, std::string& after) const
+{
+  before = m_Before;
+  after = m_After;
+  return true;
+}
@@ -0,0 +1,165 @@
+/*
+ -------------------------------------------------------------------------------
+    This file is part of the Private Message Database.
+    Copyright (C) 2026  Dirk Stolle
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ -------------------------------------------------------------------------------
+*/
+
+#include "PatternScanner.hpp"
+#include <algorithm>
+#include <cctype>
+#include <queue>
+
+namespace
+{
+
+/** \brief Converts ASCII letters to lower case, like find_ci() compares them.
+ *
+ * \param c   the character
+ * \return Returns the lower case variant of c.
+ */
+inline unsigned char lower(const char c)
+{
+  return static_cast<unsigned char>(std::tolower(static_cast<unsigned char>(c)));
+}
+
+} // namespace
+
+PatternScanner::PatternScanner()
+: m_Patterns(std::vector<std::string>()),
+  m_Classes(),
+  m_ClassCount(1),
+  m_Next(std::vector<std::uint32_t>(1, 0)),
+  m_Matches(std::vector<std::vector<std::uint32_t> >(1))
+{
+  m_Classes.fill(0);
+}
+
+std::size_t PatternScanner::add(const std::string& pattern)
+{
+  std::string lowered(pattern.length(), '\0');
+  std::transform(pattern.begin(), pattern.end(), lowered.begin(), lower);
+  const auto iter = std::find(m_Patterns.begin(), m_Patterns.end(), lowered);
+  if (iter != m_Patterns.end())
+    return static_cast<std::size_t>(iter - m_Patterns.begin());
+  m_Patterns.push_back(lowered);
+  build();
+  return m_Patterns.size() - 1;
+}
+
+std::size_t PatternScanner::size() const
+{
+  return m_Patterns.size();
+}
+
+void PatternScanner::build()
+{
+  // Characters that do not occur in any pattern share column zero, so the
+  // table stays small.
+  m_Classes.fill(0);
+  m_ClassCount = 1;
+  for (const std::string& pattern : m_Patterns)
+  {
+    for (const char c : pattern)
+    {
+      const unsigned char uc = static_cast<unsigned char>(c);
+      if (m_Classes[uc] == 0)
+      {
+        m_Classes[uc] = static_cast<std::uint8_t>(m_ClassCount);
+        ++m_ClassCount;
+      }
+      // upper case letters behave like lower case letters
+      const unsigned char upper = static_cast<unsigned char>(std::toupper(uc));
+      m_Classes[upper] = m_Classes[uc];
+    }
+  }
+
+  // trie of all patterns, zero is the root and means "no transition" here
+  m_Next.assign(m_ClassCount, 0);
+  m_Matches.assign(1, std::vector<std::uint32_t>());
+  for (std::size_t idx = 0; idx < m_Patterns.size(); ++idx)
+  {
+    std::uint32_t state = 0;
+    for (const char c : m_Patterns[idx])
+    {
+      const std::size_t cell = state * m_ClassCount + m_Classes[static_cast<unsigned char>(c)];
+      if (m_Next[cell] == 0)
+      {
+        const std::uint32_t created = static_cast<std::uint32_t>(m_Matches.size());
+        m_Matches.emplace_back();
+        m_Next.resize(m_Next.size() + m_ClassCount, 0);
+        m_Next[cell] = created;
+      }
+      state = m_Next[cell];
+    }
+    m_Matches[state].push_back(static_cast<std::uint32_t>(idx));
+  }
+
+  // Breadth-first search sets the failure links and turns missing transitions
+  // into the transitions of the failure state, so that the scan never has to
+  // follow failure links.
+  std::vector<std::uint32_t> failure(m_Matches.size(), 0);
+  std::queue<std::uint32_t> pending;
+  for (std::size_t cls = 1; cls < m_ClassCount; ++cls)
+  {
+    if (m_Next[cls] != 0)
+      pending.push(m_Next[cls]);
+  }
+  while (!pending.empty())
+  {
+    const std::uint32_t state = pending.front();
+    pending.pop();
+    const std::vector<std::uint32_t>& inherited = m_Matches[failure[state]];
+    m_Matches[state].insert(m_Matches[state].end(), inherited.begin(), inherited.end());
+    for (std::size_t cls = 0; cls < m_ClassCount; ++cls)
+    {
+      const std::size_t cell = state * m_ClassCount + cls;
+      const std::uint32_t fallback = m_Next[failure[state] * m_ClassCount + cls];
+      if ((m_Next[cell] != 0) && (cls != 0))
+      {
+        failure[m_Next[cell]] = fallback;
+        pending.push(m_Next[cell]);
+      }
+      else
+      {
+        m_Next[cell] = fallback;
+      }
+    }
+  }
+}
+
+void PatternScanner::scan(const std::string& text, std::vector<bool>& found) const
+{
+  found.assign(m_Patterns.size(), false);
+  std::size_t remaining = m_Patterns.size();
+  if (remaining == 0)
+    return;
+
+  std::uint32_t state = 0;
+  for (const char c : text)
+  {
+    state = m_Next[state * m_ClassCount + m_Classes[static_cast<unsigned char>(c)]];
+    for (const std::uint32_t pattern : m_Matches[state])
+    {
+      if (!found[pattern])
+      {
+        found[pattern] = true;
+        if (--remaining == 0)
+          return;
+      }
+    }
+  }
+}
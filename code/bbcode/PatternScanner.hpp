@@ -0,0 +1,79 @@
+/*
+ -------------------------------------------------------------------------------
+    This file is part of the Private Message Database.
+    Copyright (C) 2026  Dirk Stolle
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ -------------------------------------------------------------------------------
+*/
+
+#ifndef PATTERNSCANNER_HPP
+#define PATTERNSCANNER_HPP
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/** \brief PatternScanner:
+       Finds out which of several patterns occur in a text with a single
+       linear scan, ignoring the case of ASCII letters. The patterns are
+       compiled into an Aho-Corasick automaton, i.e. a deterministic automaton
+       where every state corresponds to a prefix of a pattern.
+*/
+class PatternScanner
+{
+  public:
+    PatternScanner();
+
+
+    /** \brief Adds a new pattern.
+     *
+     * \param pattern   the pattern, must not be empty
+     * \return Returns the index of the pattern, which is used in the result
+     *         of scan(). Adding the same pattern (ignoring case) again returns
+     *         the index of the first one.
+     * \remarks The automaton is rebuilt, so this should not be done while
+     *          parsing texts.
+     */
+    std::size_t add(const std::string& pattern);
+
+
+    /** \brief Gets the number of distinct patterns.
+     *
+     * \return Returns the number of distinct patterns.
+     */
+    std::size_t size() const;
+
+
+    /** \brief Determines which patterns occur in a text.
+     *
+     * \param text    the text to scan
+     * \param found   will be resized to size() and holds true for every
+     *                pattern that occurs in the text
+     */
+    void scan(const std::string& text, std::vector<bool>& found) const;
+  private:
+    /** \brief Builds the automaton for the current patterns. */
+    void build();
+
+
+    std::vector<std::string> m_Patterns; /**< patterns in lower case */
+    std::array<std::uint8_t, 256> m_Classes; /**< character -> column in m_Next, zero for characters that occur in no pattern */
+    std::size_t m_ClassCount; /**< number of columns in m_Next */
+    std::vector<std::uint32_t> m_Next; /**< transitions: state * m_ClassCount + class -> next state */
+    std::vector<std::vector<std::uint32_t> > m_Matches; /**< state -> patterns that end in that state */
+}; // class
+
+#endif // PATTERNSCANNER_HPP
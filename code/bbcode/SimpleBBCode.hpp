@@ -1,7 +1,7 @@
 /*
  -------------------------------------------------------------------------------
     This file is part of the Private Message Database.
-    Copyright (C) 2012, 2014, 2015  Dirk Stolle
+    Copyright (C) 2012, 2014, 2015, 2026  Dirk Stolle
 
     This program is free software: you can redistribute it and/or modify
     it under the terms of the GNU General Public License as published by
@@ -46,6 +46,15 @@ struct SimpleBBCode: public BBCode
      * \param text - the message text that (may) contain the BB code
      */
     virtual void applyToText(std::string& text) const;
+
+
+    /** \brief Gets the replacements for the opening and the closing tag.
+     *
+     * \param before   will hold the replacement for the opening tag
+     * \param after    will hold the replacement for the closing tag
+     * \return Returns true.
+     */
+    virtual bool getTagReplacements(std::string& before, std::string& after) const;
 }; // struct
 
 #endif // SIMPLEBBCODE_HPP
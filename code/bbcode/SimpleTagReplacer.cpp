@@ -0,0 +1,151 @@
+/*
+ -------------------------------------------------------------------------------
+    This file is part of the Private Message Database.
+    Copyright (C) 2026  Dirk Stolle
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ -------------------------------------------------------------------------------
+*/
+
+#include "SimpleTagReplacer.hpp"
+#include "../../libstriezel/common/StringUtils.hpp"
+
+SimpleTagReplacer::SimpleTagReplacer()
+: m_Replacements(std::vector<Replacement>()),
+  m_Index(std::unordered_map<std::string, std::size_t>()),
+  m_MaxNameLength(0)
+{
+}
+
+bool SimpleTagReplacer::add(const BBCode& code)
+{
+  Replacement replacement;
+  if (!code.getTagReplacements(replacement.before, replacement.after))
+    return false;
+
+  /* Replacements must not contain brackets or be empty, because otherwise
+     they could form new tags together with the surrounding text, and then
+     the order of the codes would matter. */
+  const std::string name = toLowerString(code.getName());
+  const auto isUsable = [](const std::string& str)
+  {
+    return !str.empty() && (str.find_first_of("[]") == std::string::npos);
+  };
+  if (!isUsable(name) || (name[0] == '/')
+      || !isUsable(replacement.before) || !isUsable(replacement.after))
+    return false;
+
+  // A second code with the same name could not find any pairs that the first
+  // one did not already replace, so it can be ignored.
+  if (m_Index.find(name) != m_Index.end())
+    return true;
+
+  m_Index[name] = m_Replacements.size();
+  m_Replacements.push_back(std::move(replacement));
+  if (name.length() > m_MaxNameLength)
+    m_MaxNameLength = name.length();
+  return true;
+}
+
+bool SimpleTagReplacer::empty() const
+{
+  return m_Replacements.empty();
+}
+
+void SimpleTagReplacer::applyToText(std::string& text) const
+{
+  if (m_Replacements.empty())
+    return;
+
+  // split text into tags of the known codes
+  std::vector<Token> tokens;
+  std::string name;
+  std::string::size_type pos = text.find('[');
+  while (pos != std::string::npos)
+  {
+    std::string::size_type start = pos + 1;
+    const bool closing = (start < text.length()) && (text[start] == '/');
+    if (closing)
+      ++start;
+    std::string::size_type end = start;
+    while ((end < text.length()) && (end - start <= m_MaxNameLength)
+           && (text[end] != ']') && (text[end] != '['))
+    {
+      ++end;
+    }
+    if ((end < text.length()) && (text[end] == ']') && (end > start))
+    {
+      name.assign(text, start, end - start);
+      const auto iter = m_Index.find(toLowerString(name));
+      if (iter != m_Index.end())
+      {
+        tokens.push_back(Token{ pos, end + 1 - pos, iter->second, closing, false });
+        pos = text.find('[', end + 1);
+        continue;
+      }
+    }
+    pos = text.find('[', pos + 1);
+  }
+
+  // Pair every opening tag with the next unused closing tag of the same code,
+  // until there is an opening tag without closing tag.
+  std::vector<std::vector<std::size_t> > opening(m_Replacements.size());
+  std::vector<std::vector<std::size_t> > closing(m_Replacements.size());
+  for (std::size_t idx = 0; idx < tokens.size(); ++idx)
+  {
+    if (tokens[idx].closing)
+      closing[tokens[idx].code].push_back(idx);
+    else
+      opening[tokens[idx].code].push_back(idx);
+  }
+  std::string::size_type resultLength = text.length();
+  bool changed = false;
+  for (std::size_t code = 0; code < m_Replacements.size(); ++code)
+  {
+    std::size_t next = 0;
+    for (const std::size_t open : opening[code])
+    {
+      while ((next < closing[code].size()) && (closing[code][next] < open))
+        ++next;
+      if (next == closing[code].size())
+        break;
+      Token& openToken = tokens[open];
+      Token& closeToken = tokens[closing[code][next]];
+      openToken.matched = true;
+      closeToken.matched = true;
+      resultLength = resultLength - openToken.length - closeToken.length
+                   + m_Replacements[code].before.length()
+                   + m_Replacements[code].after.length();
+      changed = true;
+      ++next;
+    }
+  }
+  if (!changed)
+    return;
+
+  std::string result;
+  result.reserve(resultLength);
+  std::string::size_type copied = 0;
+  for (const Token& token : tokens)
+  {
+    if (!token.matched)
+      continue;
+    result.append(text, copied, token.position - copied);
+    const Replacement& replacement = m_Replacements[token.code];
+    result.append(token.closing ? replacement.after : replacement.before);
+    copied = token.position + token.length;
+  }
+  result.append(text, copied, std::string::npos);
+  text.swap(result);
+}
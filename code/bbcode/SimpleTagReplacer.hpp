@@ -0,0 +1,88 @@
+/*
+ -------------------------------------------------------------------------------
+    This file is part of the Private Message Database.
+    Copyright (C) 2026  Dirk Stolle
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ -------------------------------------------------------------------------------
+*/
+
+#ifndef SIMPLETAGREPLACER_HPP
+#define SIMPLETAGREPLACER_HPP
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "BBCode.hpp"
+
+/** \brief SimpleTagReplacer:
+       Handles several BB codes of the form "[TAG]content[/TAG]", where the
+       opening and the closing tag are just replaced by fixed HTML code, in a
+       single pass over the text. The text is split into tags once, opening
+       and closing tags are paired per code, and the result is written at once.
+       The result is the same as applying the codes one after another.
+*/
+class SimpleTagReplacer
+{
+  public:
+    SimpleTagReplacer();
+
+
+    /** \brief Adds a BB code to the replacer.
+     *
+     * \param code   the BB code
+     * \return Returns true, if the code is handled by the replacer from now on.
+     *         Returns false, if the code cannot be handled by the replacer,
+     *         e.g. because it does not provide fixed replacements or because
+     *         the replacements could form new tags.
+     */
+    bool add(const BBCode& code);
+
+
+    /** \brief Checks whether the replacer handles any codes.
+     *
+     * \return Returns true, if no code has been added yet.
+     */
+    bool empty() const;
+
+
+    /** \brief Replaces the tags of all added codes in the given text.
+     *
+     * \param text   the message text that (may) contain the BB codes
+     */
+    void applyToText(std::string& text) const;
+  private:
+    /// replacements for the tags of one code
+    struct Replacement
+    {
+      std::string before; /**< replacement for the opening tag */
+      std::string after;  /**< replacement for the closing tag */
+    };
+
+    /// opening or closing tag in the text
+    struct Token
+    {
+      std::string::size_type position; /**< position of '[' in the text */
+      std::string::size_type length;   /**< length of the tag */
+      std::size_t code;                /**< index in m_Replacements */
+      bool closing;                    /**< whether this is a closing tag */
+      bool matched;                    /**< whether the tag gets replaced */
+    };
+
+    std::vector<Replacement> m_Replacements; /**< replacements of the codes in order of addition */
+    std::unordered_map<std::string, std::size_t> m_Index; /**< lower case code name -> index in m_Replacements */
+    std::string::size_type m_MaxNameLength; /**< length of the longest code name */
+}; // class
+
+#endif // SIMPLETAGREPLACER_HPP
@@ -1,7 +1,7 @@
 /*
  -------------------------------------------------------------------------------
     This file is part of the Private Message Database.
-    Copyright (C) 2012, 2013, 2014, 2015, 2016, 2025  Dirk Stolle
+    Copyright (C) 2012, 2013, 2014, 2015, 2016, 2025, 2026  Dirk Stolle
 
     This program is free software: you can redistribute it and/or modify
     it under the terms of the GNU General Public License as published by
@@ -61,7 +61,7 @@ void showFilteredMessages(const MessageDatabase& mdb, const FolderMap& fm, const
     std::cout << "Total: " << matches.size() << "\n";
 }
 
-int saveMessages(const MessageDatabase& mdb, const FolderMap& fm, const Compression compression, const CompressionCheck check)
+int saveMessages(MessageDatabase& mdb, const FolderMap& fm, const Compression compression, const CompressionCheck check, const unsigned int jobs, const SaveMode mode, const Storage storage)
 {
   const std::string save_dir = pmdb::paths::messages();
   // directory creation - only necessary, if there are any messages
@@ -102,7 +102,7 @@ int saveMessages(const MessageDatabase& mdb, const FolderMap& fm, const Compress
     }
   } // if more than zero messages
 
-  if (!mdb.saveMessages(save_dir, compression))
+  if (!mdb.saveMessages(save_dir, compression, jobs, mode, storage))
   {
     std::cerr << "Error: Could not save messages!\n";
     return rcFileError;
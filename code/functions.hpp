@@ -1,7 +1,7 @@
 /*
  -------------------------------------------------------------------------------
     This file is part of the Private Message Database.
-    Copyright (C) 2025  Dirk Stolle
+    Copyright (C) 2025, 2026  Dirk Stolle
 
     This program is free software: you can redistribute it and/or modify
     it under the terms of the GNU General Public License as published by
@@ -43,9 +43,13 @@ void showFilteredMessages(const MessageDatabase& mdb, const FolderMap& fm, const
  *                     compressed with zlib
  * \param check        whether or not to perform a safety check to avoid mixing
  *                     compressed and uncompressed messages
+ * \param jobs         number of threads to use for saving the messages
+ * \param mode         whether to write all messages or only those which are
+ *                     not known to exist in the save directory yet
+ * \param storage      whether to save one file per message or a message pack
  * \return Returns zero, if all messages could be saved.
  *         Returns non-zero exit code, if an error occurred.
  */
-int saveMessages(const MessageDatabase& mdb, const FolderMap& fm, const Compression compression, const CompressionCheck check);
+int saveMessages(MessageDatabase& mdb, const FolderMap& fm, const Compression compression, const CompressionCheck check, const unsigned int jobs = 1, const SaveMode mode = SaveMode::Full, const Storage storage = Storage::Directory);
 
 #endif // PMDB_FUNCTIONS_HPP
@@ -1,7 +1,7 @@
 /*
  -------------------------------------------------------------------------------
     This file is part of the Private Message Database.
-    Copyright (C) 2012, 2014, 2015, 2016, 2025  Dirk Stolle
+    Copyright (C) 2012, 2014, 2015, 2016, 2025, 2026  Dirk Stolle
 
     This program is free software: you can redistribute it and/or modify
     it under the terms of the GNU General Public License as published by
@@ -19,10 +19,15 @@
 */
 
 #include "html_generation.hpp"
+#include <algorithm>
 #include <fstream>
 #include <iostream>
+#include <set>
+#include <stdexcept>
 #include "Config.hpp"
+#include "parallel.hpp"
 #include "paths.hpp"
+#include "RenderManifest.hpp"
 #include "ReturnCodes.hpp"
 #include "bbcode/BBCodeParser.hpp"
 #include "bbcode/DefaultCodes.hpp"
@@ -34,7 +39,15 @@
 #include "../libstriezel/filesystem/directory.hpp"
 #include "../libstriezel/filesystem/file.hpp"
 
-int generateHtmlFiles(const MessageDatabase& mdb, const FolderMap& fm, const HTMLOptions htmlOptions, std::string htmlDir)
+namespace
+{
+
+/// number of messages that are processed as one work item by a thread
+constexpr std::size_t messagesPerTask = 64;
+
+} // namespace
+
+int generateHtmlFiles(const MessageDatabase& mdb, const FolderMap& fm, const HTMLOptions htmlOptions, const unsigned int jobs, std::string htmlDir)
 {
   MessageDatabase::Iterator msgIter = mdb.getBegin();
   if (msgIter == mdb.getEnd())
@@ -81,6 +94,8 @@ int generateHtmlFiles(const MessageDatabase& mdb, const FolderMap& fm, const HTM
   {
     parser.addSmilie(smilie);
   }
+  #else
+  const std::vector<Smilie> smilies_from_config;
   #endif
 
   // Ensure that template files exist.
@@ -100,6 +115,25 @@ int generateHtmlFiles(const MessageDatabase& mdb, const FolderMap& fm, const HTM
     return rcFileError;
   }
 
+  // Files of messages that are listed in the manifest are up to date, as long
+  // as the settings for HTML generation did not change.
+  pmdb::manifest::Manifest manifest;
+  const bool hasManifest = pmdb::manifest::readManifest(htmlDir, manifest);
+  const SHA256::MessageDigest fingerprint = pmdb::manifest::fingerprint(
+      theTemplate.getTemplateText(), htmlOptions, conf.getForumURL(), smilies_from_config);
+  if (!hasManifest || (manifest.fingerprint != fingerprint))
+  {
+    manifest.digests.clear();
+    // Files created with the new settings must not be taken as up to date by
+    // an outdated manifest, if the generation fails.
+    if (!pmdb::manifest::removeManifest(htmlDir))
+    {
+      std::cerr << "Error: Could not remove outdated manifest "
+                << htmlDir << pmdb::manifest::manifestFileName << "!\n";
+      return rcFileError;
+    }
+  }
+
 
   /* prepare BB code parser with BB codes */
   // image tags
@@ -156,33 +190,108 @@ int generateHtmlFiles(const MessageDatabase& mdb, const FolderMap& fm, const HTM
   std::cout << "Creating HTML files for message texts. This may take a while...\n";
   theTemplate.addReplacement("doctype", doctype(htmlOptions.standard), false);
   theTemplate.addReplacement("forum_url", conf.getForumURL(), false);
+  std::vector<const MessageStore::value_type*> messages;
+  messages.reserve(mdb.getNumberOfMessages());
+  std::set<SHA256::MessageDigest> rendered;
+  std::size_t unchanged = 0;
   while (msgIter != mdb.getEnd())
   {
-    theTemplate.addReplacement("date", msgIter->second.getDatestamp(), true);
-    theTemplate.addReplacement("title", msgIter->second.getTitle(), true);
-    theTemplate.addReplacement("fromuser", msgIter->second.getFromUser(), true);
-    theTemplate.addReplacement("fromuserid", intToString(msgIter->second.getFromUserID()), true);
-    theTemplate.addReplacement("touser", msgIter->second.getToUser(), true);
-    theTemplate.addReplacement("message", parser.parse(msgIter->second.getMessage(), conf.getForumURL(), htmlOptions.standard, htmlOptions.nl2br), false);
-    const std::string output = theTemplate.show();
-    std::ofstream htmlFile;
-    htmlFile.open(htmlDir + msgIter->first.toHexString() + ".html",
-                  std::ios_base::out | std::ios_base::binary | std::ios_base::trunc);
-    if (!htmlFile.is_open())
+    const SHA256::MessageDigest& digest = msgIter->first;
+    if ((manifest.digests.find(digest) != manifest.digests.end())
+        && libstriezel::filesystem::file::exists(htmlDir + digest.toHexString() + ".html"))
     {
-      std::cout << "Failed to open file " << htmlDir << msgIter->first.toHexString() << ".html!\n";
-      return rcFileError;
+      ++unchanged;
     }
-    htmlFile.write(output.c_str(), output.length());
-    if (!htmlFile.good())
+    else
     {
-      std::cerr << "Error while writing to file " << htmlDir << msgIter->first.toHexString() << ".html!\n";
-      htmlFile.close();
-      return rcFileError;
+      messages.push_back(&*msgIter);
     }
-    htmlFile.close();
+    rendered.emplace_hint(rendered.end(), digest);
     ++msgIter;
-  } // while
+  }
+  if (unchanged > 0)
+  {
+    std::cout << "Skipping " << unchanged << " message file(s) that are up to date.\n";
+  }
+
+  // Messages are independent of each other, so their files are created in
+  // parallel. Every task works on its own copy of the template, while the
+  // parser is shared, because parse() does not modify it.
+  enum class FileStatus: uint8_t { written, loadError, openError, writeError };
+  std::vector<FileStatus> status(messages.size(), FileStatus::written);
+  const std::size_t tasks = (messages.size() + messagesPerTask - 1) / messagesPerTask;
+  // error message per task, if the text of a message could not be loaded
+  std::vector<std::string> loadErrors(tasks);
+  const std::size_t failedTask = pmdb::parallel::forEachIndex(tasks, jobs,
+      [&](const std::size_t task)
+      {
+        MsgTemplate msgTemplate = theTemplate;
+        std::string output;
+        const std::size_t end = std::min(messages.size(), (task + 1) * messagesPerTask);
+        for (std::size_t idx = task * messagesPerTask; idx < end; ++idx)
+        {
+          const auto& [digest, pm] = *messages[idx];
+          msgTemplate.addReplacement("date", pm.getDatestamp(), true);
+          msgTemplate.addReplacement("title", pm.getTitle(), true);
+          msgTemplate.addReplacement("fromuser", pm.getFromUser(), true);
+          msgTemplate.addReplacement("fromuserid", intToString(pm.getFromUserID()), true);
+          msgTemplate.addReplacement("touser", pm.getToUser(), true);
+          try
+          {
+            // A released text is read again here, which may fail.
+            msgTemplate.addReplacement("message", parser.parse(pm.getMessage(), conf.getForumURL(), htmlOptions.standard, htmlOptions.nl2br), false);
+          }
+          catch (const std::runtime_error& ex)
+          {
+            status[idx] = FileStatus::loadError;
+            loadErrors[task] = ex.what();
+            return false;
+          }
+          output.clear();
+          msgTemplate.render(output);
+          std::ofstream htmlFile;
+          htmlFile.open(htmlDir + digest.toHexString() + ".html",
+                        std::ios_base::out | std::ios_base::binary | std::ios_base::trunc);
+          if (!htmlFile.is_open())
+          {
+            status[idx] = FileStatus::openError;
+            return false;
+          }
+          htmlFile.write(output.c_str(), output.length());
+          if (!htmlFile.good())
+          {
+            status[idx] = FileStatus::writeError;
+            htmlFile.close();
+            return false;
+          }
+          htmlFile.close();
+        }
+        return true;
+      });
+  if (failedTask != tasks)
+  {
+    std::size_t idx = failedTask * messagesPerTask;
+    while (status[idx] == FileStatus::written)
+    {
+      ++idx;
+    }
+    const std::string fileName = messages[idx]->first.toHexString() + ".html";
+    if (status[idx] == FileStatus::loadError)
+      std::cerr << "Error: " << loadErrors[failedTask] << "\n";
+    else if (status[idx] == FileStatus::openError)
+      std::cout << "Failed to open file " << htmlDir << fileName << "!\n";
+    else
+      std::cerr << "Error while writing to file " << htmlDir << fileName << "!\n";
+    return rcFileError;
+  }
+  manifest.fingerprint = fingerprint;
+  manifest.digests = std::move(rendered);
+  if (!pmdb::manifest::writeManifest(htmlDir, manifest))
+  {
+    // Not fatal, the files will just be created again next time.
+    std::cerr << "Warning: Could not write manifest "
+              << htmlDir << pmdb::manifest::manifestFileName << "!\n";
+  }
   // create index file
   MsgTemplate tplIndex, tplEntry, tplFolderList, tplFolderEntry;
   if (!tplIndex.loadFromFile(template_directory + "folder.tpl"))
@@ -1,7 +1,7 @@
 /*
  -------------------------------------------------------------------------------
     This file is part of the Private Message Database.
-    Copyright (C) 2012, 2014, 2015, 2016, 2025  Dirk Stolle
+    Copyright (C) 2012, 2014, 2015, 2016, 2025, 2026  Dirk Stolle
 
     This program is free software: you can redistribute it and/or modify
     it under the terms of the GNU General Public License as published by
@@ -30,10 +30,17 @@
  * \param mdb          the database containing the messages
  * \param fm           folder mappings for the message database
  * \param htmlOptions  the options for HTML file generation
+ * \param jobs         the maximum number of threads to use for the files of
+ *                     the messages
  * \param htmlDir      directory where the HTML files reside
  * \return Returns zero, if all HTML files could be created.
  *         Returns non-zero exit code, if an error occurred.
+ * \remarks If an error occurs, some files of messages that come later in the
+ *          database may have been created already.
+ * \remarks Files of messages that are listed in the render manifest of the
+ *          directory are not created again, unless the template, the options,
+ *          the forum URL or the smilies have changed since then.
  */
-int generateHtmlFiles(const MessageDatabase& mdb, const FolderMap& fm, const HTMLOptions htmlOptions, std::string htmlDir = "");
+int generateHtmlFiles(const MessageDatabase& mdb, const FolderMap& fm, const HTMLOptions htmlOptions, const unsigned int jobs = 1, std::string htmlDir = "");
 
 #endif // PMDB_HTML_GENERATION_HPP
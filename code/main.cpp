@@ -1,7 +1,7 @@
 /*
  -------------------------------------------------------------------------------
     This file is part of the Private Message Database.
-    Copyright (C) 2012, 2013, 2014, 2015, 2016, 2025  Dirk Stolle
+    Copyright (C) 2012, 2013, 2014, 2015, 2016, 2025, 2026  Dirk Stolle
 
     This program is free software: you can redistribute it and/or modify
     it under the terms of the GNU General Public License as published by
@@ -23,6 +23,7 @@
 #include <iostream>
 #include <optional>
 #include <set>
+#include <stdexcept>
 #include <string>
 #include <vector>
 #include "MessageDatabase.hpp"
@@ -35,8 +36,11 @@
 #include "functions.hpp"
 #include "html_generation.hpp"
 #include "HTMLOptions.hpp"
+#include "MessagePack.hpp"
 #include "open_file.hpp"
+#include "parallel.hpp"
 #include "ReturnCodes.hpp"
+#include "VerificationCache.hpp"
 #include "../libstriezel/filesystem/directory.hpp"
 #include "../libstriezel/filesystem/file.hpp"
 #include "../libstriezel/common/DirectoryFileList.hpp"
@@ -80,11 +84,30 @@ void showHelp(const std::string& name)
             << "  --load=DIR        - Tries to load all messages saved in the directory DIR.\n"
             << "                      This option can be given more than once, however the\n"
             << "                      directory has to be different every time.\n"
+            << "  --verify=MODE     - Sets how loaded messages are checked against the hash in\n"
+            << "                      their file name. MODE can be 'full' (check every\n"
+            << "                      message), 'sample' (check only every " << pmdb::verification::sampleInterval << "th message) or\n"
+            << "                      'none' (trust the file names). Files which have been\n"
+            << "                      checked before and did not change since then are not\n"
+            << "                      checked again. Default is 'full'.\n"
             << "  --save            - All messages will be saved after the XML files were read\n"
             << "                      and the messages from the load directories have been\n"
             << "                      loaded. Enabled by default.\n"
             << "  --no-save         - Prevents the program from saving any read messages.\n"
             << "                      Mutually exclusive with --save.\n"
+            << "  --store=TYPE      - Sets the way messages are saved. TYPE can be 'directory'\n"
+            << "                      (one file per message) or 'pack' (all messages in a\n"
+            << "                      single pack file with an index). Existing messages are\n"
+            << "                      converted to TYPE when saving. By default, a pack is\n"
+            << "                      used, if the save directory already contains one.\n"
+            << "  --full-save       - Writes all messages when saving. By default, only those\n"
+            << "                      messages are written which have not been loaded from the\n"
+            << "                      save directory before, because all others already exist\n"
+            << "                      there.\n"
+            << "  --normalise       - Replaces CR+LF line breaks in the texts of loaded messages\n"
+            << "                      by LF, like it is done for imported messages. Messages\n"
+            << "                      with changed text get a new hash, and their old files\n"
+            << "                      are removed when saving.\n"
             #ifndef NO_PM_COMPRESSION
             << "  --compress        - Save and load operations (see --save and --load) will use\n"
             << "                      compression, i.e. messages are compressed using zlib\n"
@@ -99,6 +122,11 @@ void showHelp(const std::string& name)
             << "                      compressed and uncompressed messages, making some of the\n"
             << "                      messages unreadable by the program.\n"
             #endif // NO_PM_COMPRESSION
+            << "  --jobs=N          - Use up to N threads for time-consuming operations like\n"
+            << "                      importing, loading or saving messages, the creation of\n"
+            << "                      HTML files or the subset check. N must be an integer\n"
+            << "                      between 1 and " << pmdb::parallel::maximumJobs << ".\n"
+            << "                      Default is 1.\n"
             << "  --html            - Creates HTML files for every message.\n"
             << "  --xhtml           - Like --html, but use XHTML instead of HTML.\n"
             << "  --no-br           - Do not convert new line characters to line breaks in\n"
@@ -135,13 +163,20 @@ int main(int argc, char **argv)
   std::optional<bool> loadDefault {};
   bool doSave = true;
   bool saveModeSpecified = false;
+  SaveMode saveMode = SaveMode::Incremental;
+  std::optional<Storage> storage {};
+  std::optional<Verification> verification {};
   Compression compression = Compression::none;
   CompressionCheck compressionCheck = CompressionCheck::Perform;
 
+  std::optional<unsigned int> jobs {};
+
   bool doHTML = false;
   HTMLOptions htmlOptions;
   bool doNotOpen = false;
 
+  bool doNormalise = false;
+
   bool searchForSubsets = false;
   std::vector<FilterUser> filters = std::vector<FilterUser>();
 
@@ -231,6 +266,49 @@ int main(int argc, char **argv)
           saveModeSpecified = true;
           std::cout << "Files will NOT be saved as requested via " << param << ".\n";
         }//param == no-save
+        else if (param == "--full-save")
+        {
+          if (saveMode == SaveMode::Full)
+          {
+            std::cerr << "Parameter " << param << " must not occur more than once!\n";
+            return rcInvalidParameter;
+          }
+          saveMode = SaveMode::Full;
+          std::cout << "All messages will be written when saving as requested via " << param << ".\n";
+        }//param == full-save
+        else if (param == "--normalise")
+        {
+          if (doNormalise)
+          {
+            std::cerr << "Parameter " << param << " must not occur more than once!\n";
+            return rcInvalidParameter;
+          }
+          doNormalise = true;
+        }//param == normalise
+        else if ((param.substr(0,8) == "--store=") && (param.length() > 8))
+        {
+          if (storage.has_value())
+          {
+            std::cerr << "Parameter --store must not occur more than once!\n";
+            return rcInvalidParameter;
+          }
+          const std::string type = param.substr(8);
+          if (type == "directory")
+          {
+            storage = Storage::Directory;
+          }
+          else if (type == "pack")
+          {
+            storage = Storage::Pack;
+          }
+          else
+          {
+            std::cerr << "Error: \"" << type << "\" is not a valid storage type. "
+                      << "Valid types are 'directory' and 'pack'.\n";
+            return rcInvalidParameter;
+          }
+          std::cout << "Messages will be saved with storage type " << type << " as requested via --store.\n";
+        }//param == 'store=...'
         else if (param == "--load-default")
         {
           const std::string defaultMessageDirectory = pmdb::paths::messages() + libstriezel::filesystem::pathDelimiter;
@@ -291,6 +369,34 @@ int main(int argc, char **argv)
           loadDirs.insert(pathToDir);
           std::cout << "Directory \"" << pathToDir << "\" was queued for loading.\n";
         }//param == 'load=...'
+        else if ((param.substr(0,9) == "--verify=") && (param.length() > 9))
+        {
+          if (verification.has_value())
+          {
+            std::cerr << "Parameter --verify must not occur more than once!\n";
+            return rcInvalidParameter;
+          }
+          const std::string mode = param.substr(9);
+          if (mode == "full")
+          {
+            verification = Verification::Full;
+          }
+          else if (mode == "sample")
+          {
+            verification = Verification::Sample;
+          }
+          else if (mode == "none")
+          {
+            verification = Verification::None;
+          }
+          else
+          {
+            std::cerr << "Error: \"" << mode << "\" is not a valid verification mode. "
+                      << "Valid modes are 'full', 'sample' and 'none'.\n";
+            return rcInvalidParameter;
+          }
+          std::cout << "Loaded messages will be verified with mode " << mode << " as requested via --verify.\n";
+        }//param == 'verify=...'
         else if ((param == "--html") || (param == "--HTML"))
         {
           if (doHTML)
@@ -354,6 +460,26 @@ int main(int argc, char **argv)
           }
           compressionCheck = CompressionCheck::Skip;
         }
+        else if ((param.substr(0,7) == "--jobs=") && (param.length() > 7))
+        {
+          if (jobs.has_value())
+          {
+            std::cerr << "Parameter --jobs must not occur more than once!\n";
+            return rcInvalidParameter;
+          }
+          const std::string number = param.substr(7);
+          unsigned int value = 0;
+          if (!stringToUnsignedInt(number, value) || (value == 0)
+              || (value > pmdb::parallel::maximumJobs))
+          {
+            std::cerr << "Error: \"" << number << "\" is not a valid number of "
+                      << "jobs. It has to be an integer between 1 and "
+                      << pmdb::parallel::maximumJobs << ".\n";
+            return rcInvalidParameter;
+          }
+          jobs = value;
+          std::cout << "Up to " << value << " thread(s) will be used as requested via --jobs.\n";
+        }//param == 'jobs=...'
         else if ((param.substr(0,8) == "--table=") && (param.length() > 8))
         {
           htmlOptions.tableClasses.table = param.substr(8);
@@ -489,11 +615,16 @@ int main(int argc, char **argv)
   FolderMap fm;
   uint32_t PMs_done, PMs_new;
 
+  // Message texts are only needed for normalisation, HTML files and the subset
+  // check. In all other cases they are read again from the files when they are
+  // saved.
+  const LoadMode loadMode = (doNormalise || doHTML || searchForSubsets) ? LoadMode::Full : LoadMode::Headers;
+
   // try to load data from directories
   for (const auto& directory: loadDirs)
   {
     std::cout << "Loading messages from " << directory << " ...\n";
-    if (!mdb.loadMessages(directory, PMs_done, PMs_new, compression))
+    if (!mdb.loadMessages(directory, PMs_done, PMs_new, compression, jobs.value_or(1), verification.value_or(Verification::Full), loadMode))
     {
       std::cerr << "Could not load all messages from \"" << directory
                 << "\"!\nRead so far: " << PMs_done << "; new: " << PMs_new
@@ -512,7 +643,7 @@ int main(int argc, char **argv)
   // try to load XML files
   for (const auto& path: pathXML)
   {
-    if (mdb.importFromFile(path, PMs_done, PMs_new, fm))
+    if (mdb.importFromFile(path, PMs_done, PMs_new, fm, jobs.value_or(1)))
     {
       std::cout << "Import of private messages from " << path << " was successful.\n  "
                 << PMs_done << " PMs read, new PMs: " << PMs_new << "\n";
@@ -525,11 +656,23 @@ int main(int argc, char **argv)
     }
   }
 
+  if (doNormalise)
+  {
+    std::size_t changed = 0;
+    if (!mdb.normaliseMessages(changed, fm, jobs.value_or(1)))
+    {
+      std::cerr << "Error: Could not normalise all messages!\n";
+      return rcFileError;
+    }
+    std::cout << "Line breaks of " << changed << " message(s) have been normalised.\n";
+  }
+
   std::cout << "PMs in the database: " << mdb.getNumberOfMessages() << "\n";
 
   if (doSave)
   {
-    const int rc = saveMessages(mdb, fm, compression, compressionCheck);
+    const Storage saveStorage = storage.value_or(pmdb::pack::exists(pmdb::paths::messages()) ? Storage::Pack : Storage::Directory);
+    const int rc = saveMessages(mdb, fm, compression, compressionCheck, jobs.value_or(1), saveMode, saveStorage);
     if (rc != 0)
     {
       return rc;
@@ -538,7 +681,7 @@ int main(int argc, char **argv)
 
   if (doHTML)
   {
-    const int rc = generateHtmlFiles(mdb, fm, htmlOptions);
+    const int rc = generateHtmlFiles(mdb, fm, htmlOptions, jobs.value_or(1));
     if (rc != 0)
     {
       return rc;
@@ -564,7 +707,28 @@ int main(int argc, char **argv)
     }
 
     std::cout << "Searching for message texts that are contained in others. This may take a while...\n";
-    std::map<md_date, std::vector<md_date> > subsets = mdb.getTextSubsets();
+    unsigned int lastPercentage = 101;
+    const auto showProgress = [&lastPercentage](const std::size_t done, const std::size_t total)
+    {
+      const unsigned int percentage = (total == 0) ? 100 : static_cast<unsigned int>(done * 100 / total);
+      if (percentage != lastPercentage)
+      {
+        lastPercentage = percentage;
+        std::cout << "\rProgress: " << percentage << " %" << std::flush;
+      }
+    };
+    std::map<md_date, std::vector<md_date> > subsets;
+    try
+    {
+      subsets = mdb.getTextSubsets(jobs.value_or(1), showProgress);
+    }
+    catch (const std::runtime_error& ex)
+    {
+      // Released texts are read again for the check, which may fail.
+      std::cerr << "\nError: " << ex.what() << "\n";
+      return rcFileError;
+    }
+    std::cout << "\n";
     std::map<md_date, std::vector<md_date> >::iterator subIter = subsets.begin();
     std::set<SHA256::MessageDigest> redundantMessages;
     while (subIter != subsets.end())
@@ -1,7 +1,7 @@
 /*
  -------------------------------------------------------------------------------
     This file is part of the Private Message Database.
-    Copyright (C) 2025  Dirk Stolle
+    Copyright (C) 2025, 2026  Dirk Stolle
 
     This program is free software: you can redistribute it and/or modify
     it under the terms of the GNU General Public License as published by
@@ -33,8 +33,8 @@
   #endif
 #endif
 #include "browser_detection.hpp"
+#include "sha256_backend.hpp"
 #include "../libstriezel/filesystem/directory.hpp"
-#include "../libstriezel/hash/sha256/BufferSourceUtility.hpp"
 
 std::string getFirstFolderFileName(const FolderMap& fm)
 {
@@ -45,7 +45,7 @@ std::string getFirstFolderFileName(const FolderMap& fm)
   }
   const std::string& name = *folders.begin();
   return "folder_"
-    + SHA256::computeFromBuffer((uint8_t*) name.c_str(), name.length() * 8).toHexString()
+    + pmdb::sha256::computeFromString(name).toHexString()
     + ".html";
 }
 
@@ -0,0 +1,158 @@
+/*
+ -------------------------------------------------------------------------------
+    This file is part of the Private Message Database.
+    Copyright (C) 2026  Dirk Stolle
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ -------------------------------------------------------------------------------
+*/
+
+#ifndef PMDB_PARALLEL_HPP
+#define PMDB_PARALLEL_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+namespace pmdb::parallel
+{
+
+/// maximum number of jobs that can be requested via --jobs
+constexpr unsigned int maximumJobs = 1024;
+
+
+/** \brief Determines the number of threads to use for a certain amount of work.
+ *
+ * \param jobs   the number of requested jobs
+ * \param items  the number of work items
+ * \return Returns the number of threads to use, which is at least one and
+ *         never more than the number of work items.
+ */
+inline unsigned int workerCount(const unsigned int jobs, const std::size_t items)
+{
+  if ((jobs <= 1) || (items <= 1))
+    return 1;
+  if (items < jobs)
+    return static_cast<unsigned int>(items);
+  return jobs;
+}
+
+
+/** \brief Calls a function for every index in [0;count), using up to jobs
+ *         threads at the same time.
+ *
+ * \param count  the number of work items
+ * \param jobs   the maximum number of threads to use
+ * \param func   function that takes an index (std::size_t) and returns true
+ *               on success or false on failure
+ * \return Returns the lowest index for which func returned false, or count,
+ *         if func succeeded for every index. All indices below the returned
+ *         value have been processed successfully, indices above it may or may
+ *         not have been processed.
+ * \remarks Indices are handed out in ascending order. After the first failure
+ *          no further indices are handed out, so a failure stops the work as
+ *          early as possible. If func throws, the exception is rethrown in the
+ *          calling thread once all threads have finished. If the system
+ *          cannot start as many threads as requested, the threads which have
+ *          been started and the calling thread do the work.
+ */
+template<typename Function>
+std::size_t forEachIndex(const std::size_t count, const unsigned int jobs, Function func)
+{
+  const unsigned int workers = workerCount(jobs, count);
+  if (workers == 1)
+  {
+    for (std::size_t idx = 0; idx < count; ++idx)
+    {
+      if (!func(idx))
+        return idx;
+    }
+    return count;
+  }
+
+  std::atomic<std::size_t> next{0};
+  std::atomic<std::size_t> firstFailure{count};
+  std::exception_ptr exception = nullptr;
+  std::mutex exceptionMutex;
+
+  const auto markFailure = [&firstFailure](const std::size_t idx)
+  {
+    std::size_t current = firstFailure.load();
+    while ((idx < current) && !firstFailure.compare_exchange_weak(current, idx))
+    {
+      // Nothing to do here, compare_exchange_weak() updates current.
+    }
+  };
+
+  const auto worker = [&]()
+  {
+    while (true)
+    {
+      const std::size_t idx = next.fetch_add(1);
+      if ((idx >= count) || (idx > firstFailure.load()))
+        return;
+      try
+      {
+        if (!func(idx))
+        {
+          markFailure(idx);
+        }
+      }
+      catch (...)
+      {
+        {
+          const std::lock_guard<std::mutex> guard(exceptionMutex);
+          if (exception == nullptr)
+            exception = std::current_exception();
+        }
+        markFailure(idx);
+      }
+    }
+  };
+
+  std::vector<std::thread> threads;
+  threads.reserve(workers - 1);
+  for (unsigned int i = 1; i < workers; ++i)
+  {
+    try
+    {
+      threads.emplace_back(worker);
+    }
+    catch (const std::system_error&)
+    {
+      // No more threads available, so the running ones have to do the rest.
+      break;
+    }
+  }
+  // The calling thread does its share of the work, too.
+  worker();
+  for (auto& thread: threads)
+  {
+    thread.join();
+  }
+
+  if (exception != nullptr)
+  {
+    std::rethrow_exception(exception);
+  }
+  return firstFailure.load();
+}
+
+} // namespace
+
+#endif // PMDB_PARALLEL_HPP
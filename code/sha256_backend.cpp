@@ -0,0 +1,208 @@
+/*
+ -------------------------------------------------------------------------------
+    This file is part of the Private Message Database.
+    Copyright (C) 2026  Dirk Stolle
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ -------------------------------------------------------------------------------
+*/
+
+#include "sha256_backend.hpp"
+#include <cstdint>
+#include "../libstriezel/hash/sha256/BufferSource.hpp"
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+  #define PMDB_SHA_EXTENSIONS
+  #include <immintrin.h>
+  #if defined(_MSC_VER)
+    #include <intrin.h>
+    #define PMDB_TARGET_SHA
+  #else
+    #include <cpuid.h>
+    #define PMDB_TARGET_SHA __attribute__((target("sha,sse4.1")))
+  #endif
+#endif
+
+namespace pmdb::sha256
+{
+
+#ifdef PMDB_SHA_EXTENSIONS
+namespace
+{
+
+/** \brief Checks whether the processor supports the SHA extensions and the
+ *         SSE4.1 instructions that are needed alongside them.
+ */
+bool cpuHasShaExtensions()
+{
+  #if defined(_MSC_VER)
+  int info[4] = { 0, 0, 0, 0 };
+  __cpuid(info, 0);
+  if (info[0] < 7)
+    return false;
+  __cpuid(info, 1);
+  const bool sse41 = (info[2] & (1 << 19)) != 0;
+  __cpuidex(info, 7, 0);
+  const bool sha = (info[1] & (1 << 29)) != 0;
+  #else
+  unsigned int eax = 0, ebx = 0, ecx = 0, edx = 0;
+  if (__get_cpuid_max(0, nullptr) < 7)
+    return false;
+  __get_cpuid(1, &eax, &ebx, &ecx, &edx);
+  const bool sse41 = (ecx & (1u << 19)) != 0;
+  __cpuid_count(7, 0, eax, ebx, ecx, edx);
+  const bool sha = (ebx & (1u << 29)) != 0;
+  #endif
+  return sse41 && sha;
+}
+
+
+/// round constants of SHA-256
+alignas(16) const uint32_t roundConstants[64] = {
+  0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+  0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+  0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+  0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+  0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+  0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+  0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+  0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+
+/** \brief Calculates the hash with the SHA extensions.
+ *
+ * \param source  the message source
+ * \return Returns the SHA-256 message digest of the data.
+ * \remarks The message blocks of libstriezel already hold the message words
+ *          in host byte order, so they are loaded without a byte shuffle.
+ */
+PMDB_TARGET_SHA SHA256::MessageDigest computeWithShaExtensions(SHA256::MessageSource& source)
+{
+  alignas(16) uint32_t state[8] = {
+    0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+    0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+  };
+
+  // The instructions expect the state as ABEF and CDGH.
+  __m128i tmp = _mm_load_si128(reinterpret_cast<const __m128i*>(&state[0]));
+  __m128i state1 = _mm_load_si128(reinterpret_cast<const __m128i*>(&state[4]));
+  tmp = _mm_shuffle_epi32(tmp, 0xB1);
+  state1 = _mm_shuffle_epi32(state1, 0x1B);
+  __m128i state0 = _mm_alignr_epi8(tmp, state1, 8);
+  state1 = _mm_blend_epi16(state1, tmp, 0xF0);
+
+  SHA256::MessageBlock block;
+  while (source.getNextMessageBlock(block))
+  {
+    const __m128i abefSave = state0;
+    const __m128i cdghSave = state1;
+    __m128i words[4];
+
+    // 16 groups of four rounds each
+    for (unsigned int i = 0; i < 16; ++i)
+    {
+      __m128i& current = words[i % 4];
+      if (i < 4)
+      {
+        current = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&block.words[4 * i]));
+      }
+      __m128i msg = _mm_add_epi32(current, _mm_load_si128(reinterpret_cast<const __m128i*>(&roundConstants[4 * i])));
+      state1 = _mm_sha256rnds2_epu32(state1, state0, msg);
+      if ((i >= 3) && (i <= 14))
+      {
+        // finish the message schedule of the next group
+        __m128i& next = words[(i + 1) % 4];
+        next = _mm_add_epi32(next, _mm_alignr_epi8(current, words[(i + 3) % 4], 4));
+        next = _mm_sha256msg2_epu32(next, current);
+      }
+      msg = _mm_shuffle_epi32(msg, 0x0E);
+      state0 = _mm_sha256rnds2_epu32(state0, state1, msg);
+      if ((i >= 1) && (i <= 12))
+      {
+        // start the message schedule of the group after the next three
+        __m128i& previous = words[(i + 3) % 4];
+        previous = _mm_sha256msg1_epu32(previous, current);
+      }
+    }
+
+    state0 = _mm_add_epi32(state0, abefSave);
+    state1 = _mm_add_epi32(state1, cdghSave);
+  }
+
+  // back from ABEF and CDGH to ABCD and EFGH
+  tmp = _mm_shuffle_epi32(state0, 0x1B);
+  state1 = _mm_shuffle_epi32(state1, 0xB1);
+  state0 = _mm_blend_epi16(tmp, state1, 0xF0);
+  state1 = _mm_alignr_epi8(state1, tmp, 8);
+  _mm_store_si128(reinterpret_cast<__m128i*>(&state[0]), state0);
+  _mm_store_si128(reinterpret_cast<__m128i*>(&state[4]), state1);
+
+  SHA256::MessageDigest digest;
+  for (unsigned int i = 0; i < 8; ++i)
+  {
+    digest.hash[i] = state[i];
+  }
+  return digest;
+}
+
+} // anonymous namespace
+#endif // PMDB_SHA_EXTENSIONS
+
+
+bool isSupported(const Backend backend)
+{
+  switch (backend)
+  {
+    case Backend::Portable:
+         return true;
+    case Backend::ShaExtensions:
+         #ifdef PMDB_SHA_EXTENSIONS
+         return cpuHasShaExtensions();
+         #else
+         return false;
+         #endif
+  }
+  return false;
+}
+
+Backend fastestBackend()
+{
+  static const Backend fastest = isSupported(Backend::ShaExtensions)
+                               ? Backend::ShaExtensions : Backend::Portable;
+  return fastest;
+}
+
+SHA256::MessageDigest computeFromSource(SHA256::MessageSource& source, const Backend backend)
+{
+  #ifdef PMDB_SHA_EXTENSIONS
+  if (backend == Backend::ShaExtensions)
+    return computeWithShaExtensions(source);
+  #endif
+  return SHA256::computeFromSource(source);
+}
+
+SHA256::MessageDigest computeFromSource(SHA256::MessageSource& source)
+{
+  return computeFromSource(source, fastestBackend());
+}
+
+SHA256::MessageDigest computeFromString(const std::string& data)
+{
+  // BufferSource only reads the data, the cast is just for its interface.
+  SHA256::BufferSource source(reinterpret_cast<uint8_t*>(const_cast<char*>(data.data())), data.length() * 8);
+  return pmdb::sha256::computeFromSource(source);
+}
+
+} // namespace
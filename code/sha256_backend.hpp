@@ -0,0 +1,85 @@
+/*
+ -------------------------------------------------------------------------------
+    This file is part of the Private Message Database.
+    Copyright (C) 2026  Dirk Stolle
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ -------------------------------------------------------------------------------
+*/
+
+#ifndef PMDB_SHA256_BACKEND_HPP
+#define PMDB_SHA256_BACKEND_HPP
+
+#include <string>
+#include "../libstriezel/hash/sha256/MessageSource.hpp"
+#include "../libstriezel/hash/sha256/sha256.hpp"
+
+namespace pmdb::sha256
+{
+
+/** enumeration type for implementations of the SHA-256 block function */
+enum class Backend
+{
+  /** portable implementation of libstriezel */
+  Portable,
+
+  /** implementation with the SHA extensions of x86 processors */
+  ShaExtensions
+};
+
+
+/** \brief Checks whether a backend can be used on the current processor.
+ *
+ * \param backend  the backend to check
+ * \return Returns true, if the backend can be used. Returns false otherwise.
+ */
+bool isSupported(const Backend backend);
+
+
+/** \brief Gets the fastest backend that can be used on the current processor.
+ *
+ * \return Returns the fastest supported backend. The processor is only checked
+ *         once, later calls return the same value.
+ */
+Backend fastestBackend();
+
+
+/** \brief Calculates the SHA-256 hash of the data of a message source.
+ *
+ * \param source   the message source
+ * \param backend  the backend to use, must be supported by the processor
+ * \return Returns the SHA-256 message digest of the data.
+ */
+SHA256::MessageDigest computeFromSource(SHA256::MessageSource& source, const Backend backend);
+
+
+/** \brief Calculates the SHA-256 hash of the data of a message source with
+ *         the fastest backend.
+ *
+ * \param source   the message source
+ * \return Returns the SHA-256 message digest of the data.
+ */
+SHA256::MessageDigest computeFromSource(SHA256::MessageSource& source);
+
+
+/** \brief Calculates the SHA-256 hash of a string with the fastest backend.
+ *
+ * \param data  the string
+ * \return Returns the SHA-256 message digest of the string.
+ */
+SHA256::MessageDigest computeFromString(const std::string& data);
+
+} // namespace
+
+#endif // PMDB_SHA256_BACKEND_HPP
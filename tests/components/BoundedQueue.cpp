@@ -0,0 +1,85 @@
+/*
+ -------------------------------------------------------------------------------
+    This file is part of the Private Message Database.
+    Copyright (C) 2026  Dirk Stolle
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ -------------------------------------------------------------------------------
+*/
+
+#include "../locate_catch.hpp"
+#include <thread>
+#include <vector>
+#include "../../code/BoundedQueue.hpp"
+
+TEST_CASE("BoundedQueue")
+{
+  using namespace pmdb::parallel;
+
+  SECTION("items come out in the order they went in")
+  {
+    BoundedQueue<int> queue(4);
+    REQUIRE( queue.push(1) );
+    REQUIRE( queue.push(2) );
+    REQUIRE( queue.push(3) );
+
+    int item = 0;
+    REQUIRE( queue.pop(item) );
+    REQUIRE( item == 1 );
+    REQUIRE( queue.pop(item) );
+    REQUIRE( item == 2 );
+    REQUIRE( queue.pop(item) );
+    REQUIRE( item == 3 );
+  }
+
+  SECTION("closed queue hands out remaining items")
+  {
+    BoundedQueue<int> queue(4);
+    REQUIRE( queue.push(5) );
+    queue.close();
+    REQUIRE_FALSE( queue.push(6) );
+
+    int item = 0;
+    REQUIRE( queue.pop(item) );
+    REQUIRE( item == 5 );
+    REQUIRE_FALSE( queue.pop(item) );
+  }
+
+  SECTION("producer and consumer on different threads")
+  {
+    BoundedQueue<int> queue(2);
+    std::thread producer([&queue]()
+    {
+      for (int i = 0; i < 1000; ++i)
+      {
+        queue.push(std::move(i));
+      }
+      queue.close();
+    });
+
+    std::vector<int> received;
+    int item = 0;
+    while (queue.pop(item))
+    {
+      received.push_back(item);
+    }
+    producer.join();
+
+    REQUIRE( received.size() == 1000 );
+    for (int i = 0; i < 1000; ++i)
+    {
+      REQUIRE( received[i] == i );
+    }
+  }
+}
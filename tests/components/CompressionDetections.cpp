@@ -1,7 +1,7 @@
 /*
  -------------------------------------------------------------------------------
     This file is part of the Private Message Database.
-    Copyright (C) 2025  Dirk Stolle
+    Copyright (C) 2025, 2026  Dirk Stolle
 
     This program is free software: you can redistribute it and/or modify
     it under the terms of the GNU General Public License as published by
@@ -22,6 +22,7 @@
 #include <filesystem>
 #include <fstream>
 #include "../../code/CompressionDetection.hpp"
+#include "../../code/MessagePack.hpp"
 #include "../../code/PrivateMessage.hpp"
 #include "../FileGuard.hpp"
 
@@ -135,4 +136,44 @@ TEST_CASE("detect_compression")
     REQUIRE( fs::remove(path / hash) );
     REQUIRE( fs::remove(path) );
   }
+
+  SECTION("directory with message pack")
+  {
+    const fs::path path{fs::temp_directory_path() / "pm_pack_messages_directory"};
+    REQUIRE( fs::create_directory(path) );
+    FileGuard guard{path};
+
+    const auto compression = GENERATE(Compression::none, Compression::zlib);
+    {
+      std::ofstream stream(path / pmdb::pack::packFileName, std::ios::out | std::ios::binary);
+      REQUIRE( pmdb::pack::writeHeader(stream, compression) );
+      std::string record;
+      REQUIRE( getExampleMessage().saveToBuffer(record, compression) );
+      REQUIRE( stream.write(record.data(), record.size()).good() );
+    }
+
+    const auto detected = detect_compression(path.string());
+    REQUIRE( detected.has_value() );
+    REQUIRE( detected.value() == compression );
+    REQUIRE( fs::remove(path / pmdb::pack::packFileName) );
+    REQUIRE( fs::remove(path) );
+  }
+
+  SECTION("directory with invalid message pack")
+  {
+    const fs::path path{fs::temp_directory_path() / "pm_invalid_pack_directory"};
+    REQUIRE( fs::create_directory(path) );
+    FileGuard guard{path};
+
+    {
+      std::ofstream stream(path / pmdb::pack::packFileName, std::ios::out | std::ios::binary);
+      stream << "not a pack";
+    }
+    // A valid message file does not matter, if the pack is broken.
+    REQUIRE( getExampleMessage().saveToFile((path / getExampleMessage().getHash().toHexString()).string(), Compression::none) );
+
+    const auto detected = detect_compression(path.string());
+    REQUIRE_FALSE( detected.has_value() );
+    REQUIRE( fs::remove_all(path) == 3 );
+  }
 }
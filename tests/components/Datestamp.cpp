@@ -0,0 +1,79 @@
+/*
+ -------------------------------------------------------------------------------
+    This file is part of the Private Message Database.
+    Copyright (C) 2026  Dirk Stolle
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ -------------------------------------------------------------------------------
+*/
+
+#include "../locate_catch.hpp"
+#include <algorithm>
+#include <string>
+#include <vector>
+#include "../../code/Datestamp.hpp"
+
+TEST_CASE("Datestamp")
+{
+  SECTION("empty datestamp")
+  {
+    const Datestamp ds;
+    REQUIRE( ds.empty() );
+    REQUIRE( ds.length() == 0 );
+    REQUIRE( ds.toString().empty() );
+    REQUIRE( ds == Datestamp("") );
+  }
+
+  SECTION("text is kept exactly")
+  {
+    const auto text = GENERATE(as<std::string>{},
+        "2007-06-14 12:34", "2007-06-14 12:34:56", "0000-00-00 00:00",
+        "9999-99-99 99:99:99", "2007-06-14", "14.06.2007 12:34",
+        "2007-06-14T12:34", "2007-06-14 12:34:5x", "an arbitrary text");
+    const Datestamp ds(text);
+    REQUIRE( ds.toString() == text );
+    REQUIRE( ds.length() == text.length() );
+    REQUIRE_FALSE( ds.empty() );
+    REQUIRE( ds == Datestamp(text) );
+
+    Datestamp::Buffer buffer;
+    const std::string_view view = ds.view(buffer);
+    REQUIRE( view == text );
+    REQUIRE( view.data()[view.size()] == '\0' );
+  }
+
+  SECTION("comparison")
+  {
+    REQUIRE( Datestamp("2007-06-14 12:34") != Datestamp("2007-06-14 12:35") );
+    REQUIRE( Datestamp("2007-06-14 12:34") != Datestamp("2007-06-14 12:34:00") );
+    REQUIRE( Datestamp("2007-06-14 12:34") != Datestamp("something else") );
+  }
+
+  SECTION("order is the same as the order of the texts")
+  {
+    const std::vector<std::string> texts = {
+        "2007-06-14 12:34", "2007-06-14 12:34:00", "2007-06-14 12:34:59",
+        "2007-06-14 12:35", "2007-06-15 00:00", "2007-07-01 00:00",
+        "2008-01-01 00:00", "1999-12-31 23:59", "", "2007", "2007-06-14 12:34x",
+        "2007-06-14 12:3", "Z", "0000-00-00 00:00"
+    };
+    for (const auto& a: texts)
+    {
+      for (const auto& b: texts)
+      {
+        REQUIRE( (Datestamp(a) < Datestamp(b)) == (a < b) );
+      }
+    }
+  }
+}
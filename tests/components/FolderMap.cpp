@@ -1,7 +1,7 @@
 /*
  -------------------------------------------------------------------------------
     This file is part of the Private Message Database test suite.
-    Copyright (C) 2015, 2022, 2025  Dirk Stolle
+    Copyright (C) 2015, 2022, 2025, 2026  Dirk Stolle
 
     This program is free software: you can redistribute it and/or modify
     it under the terms of the GNU General Public License as published by
@@ -139,6 +139,33 @@ TEST_CASE("FolderMap")
     REQUIRE(*(++folders.begin()) == "Folder #2" );
   }
 
+  SECTION("remove entry")
+  {
+    FolderMap fm;
+
+    // create two example hashes
+    SHA256::MessageDigest digest_one;
+    REQUIRE( digest_one.fromHexString("2d95696c3c83910d9ee999cda9c6f23fba73dbb597390fdae6edc723163bf81e") );
+    SHA256::MessageDigest digest_two;
+    REQUIRE( digest_two.fromHexString("a3d17e5bb63d7f73a850265e95c1b7a3699058ff6ca55f8a1e2ee3eab7e3398e") );
+
+    fm.add(digest_one, "A folder's name");
+    fm.add(digest_two, "Folder #2");
+
+    fm.remove(digest_one);
+    REQUIRE_FALSE( fm.hasEntry(digest_one) );
+    REQUIRE( fm.hasEntry(digest_two) );
+    REQUIRE( fm.getFolderName(digest_two) == "Folder #2" );
+    // The folder of the removed message is gone, too.
+    const std::set<std::string> folders = fm.getPresentFolders();
+    REQUIRE( folders.size() == 1 );
+    REQUIRE( *folders.begin() == "Folder #2" );
+
+    // Removing a message without entry does nothing.
+    REQUIRE_NOTHROW( fm.remove(digest_one) );
+    REQUIRE( fm.hasEntry(digest_two) );
+  }
+
   SECTION("save + load")
   {
     namespace fs = std::filesystem;
@@ -0,0 +1,81 @@
+/*
+ -------------------------------------------------------------------------------
+    This file is part of the Private Message Database.
+    Copyright (C) 2026  Dirk Stolle
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ -------------------------------------------------------------------------------
+*/
+
+#include "../locate_catch.hpp"
+#include <filesystem>
+#include <fstream>
+#include <string_view>
+#include "../../code/MappedFile.hpp"
+#include "../FileGuard.hpp"
+
+TEST_CASE("MappedFile")
+{
+  namespace fs = std::filesystem;
+
+  SECTION("default state")
+  {
+    MappedFile file;
+    REQUIRE( file.data() == nullptr );
+    REQUIRE( file.size() == 0 );
+  }
+
+  SECTION("failure: file does not exist")
+  {
+    MappedFile file;
+    REQUIRE_FALSE( file.open("/does/not/exist/mapped.txt") );
+    REQUIRE( file.data() == nullptr );
+    REQUIRE( file.size() == 0 );
+  }
+
+  SECTION("map file with content")
+  {
+    const fs::path path{fs::temp_directory_path() / "pmdb_mapped_file.txt"};
+    constexpr std::string_view content{"This is\0a test.", 15};
+    {
+      std::ofstream stream(path, std::ios::out | std::ios::binary);
+      stream.write(content.data(), content.size());
+      REQUIRE( stream.good() );
+    }
+    FileGuard guard{path};
+
+    MappedFile file;
+    REQUIRE( file.open(path.string()) );
+    REQUIRE( file.size() == content.size() );
+    REQUIRE( std::string_view(file.data(), file.size()) == content );
+
+    file.close();
+    REQUIRE( file.data() == nullptr );
+    REQUIRE( file.size() == 0 );
+  }
+
+  SECTION("map empty file")
+  {
+    const fs::path path{fs::temp_directory_path() / "pmdb_mapped_empty_file.txt"};
+    {
+      std::ofstream stream(path, std::ios::out | std::ios::binary);
+      REQUIRE( stream.good() );
+    }
+    FileGuard guard{path};
+
+    MappedFile file;
+    REQUIRE( file.open(path.string()) );
+    REQUIRE( file.size() == 0 );
+  }
+}
@@ -1,7 +1,7 @@
 /*
  -------------------------------------------------------------------------------
     This file is part of the Private Message Database test suite.
-    Copyright (C) 2015, 2025  Dirk Stolle
+    Copyright (C) 2015, 2025, 2026  Dirk Stolle
 
     This program is free software: you can redistribute it and/or modify
     it under the terms of the GNU General Public License as published by
@@ -18,13 +18,19 @@
  -------------------------------------------------------------------------------
 */
 
+#include <chrono>
 #include <exception>
 #include <filesystem>
 #include <fstream>
+#include <iterator>
+#include <string>
 #include <string_view>
 #include "../locate_catch.hpp"
 #include "../FileGuard.hpp"
 #include "../../code/MessageDatabase.hpp"
+#include "../../code/MessagePack.hpp"
+#include "../../code/VerificationCache.hpp"
+#include "../../code/sha256_backend.hpp"
 
 bool writeMessage(const std::filesystem::path& path, const std::string_view content)
 {
@@ -70,6 +76,88 @@ TEST_CASE("MessageDatabase")
     REQUIRE( mdb.getNumberOfMessages() == 1 );
   }
 
+  SECTION("move message into database")
+  {
+    MessageDatabase mdb;
+
+    PrivateMessage pm;
+    pm.setDatestamp("2007-06-14 12:34");
+    pm.setTitle("This is the title");
+    pm.setFromUser("Hermes");
+    pm.setFromUserID(234);
+    pm.setToUser("Poseidon");
+    pm.setMessage("This is a message.");
+    PrivateMessage copy = pm;
+    const SHA256::MessageDigest digest = pm.getHash();
+
+    // database should accept the copy
+    REQUIRE( mdb.addMessage(std::move(copy)) );
+    REQUIRE( mdb.getNumberOfMessages() == 1 );
+    REQUIRE( mdb.getMessage(digest) == pm );
+
+    // A rejected message must not be moved from.
+    PrivateMessage duplicate = pm;
+    REQUIRE_FALSE( mdb.addMessage(std::move(duplicate)) );
+    REQUIRE( duplicate == pm );
+    REQUIRE( duplicate.getMessage() == "This is a message." );
+    REQUIRE( mdb.getNumberOfMessages() == 1 );
+  }
+
+  SECTION("normaliseMessages")
+  {
+    MessageDatabase mdb;
+
+    PrivateMessage pm;
+    pm.setDatestamp("2007-06-14 12:34");
+    pm.setTitle("This is the title");
+    pm.setFromUser("Hermes");
+    pm.setFromUserID(234);
+    pm.setToUser("Poseidon");
+    pm.setMessage("Line one.\r\nLine two.");
+    PrivateMessage unixPM = pm;
+    unixPM.setMessage("Line one.\nLine two.");
+    PrivateMessage other = pm;
+    other.setMessage("Nothing to change here.");
+
+    PrivateMessage otherCR = pm;
+    otherCR.setMessage("Another\r\nmessage.");
+    PrivateMessage otherUnix = pm;
+    otherUnix.setMessage("Another\nmessage.");
+
+    REQUIRE( mdb.addMessage(pm) );
+    REQUIRE( mdb.addMessage(unixPM) );
+    REQUIRE( mdb.addMessage(other) );
+    REQUIRE( mdb.addMessage(otherCR) );
+    REQUIRE( mdb.getNumberOfMessages() == 4 );
+
+    FolderMap fm;
+    fm.add(pm.getHash(), "Old folder");
+    fm.add(unixPM.getHash(), "Inbox");
+    fm.add(otherCR.getHash(), "Outbox");
+
+    std::size_t changed = 0;
+    REQUIRE( mdb.normaliseMessages(changed, fm, 4) );
+    REQUIRE( changed == 2 );
+    // The normalised message is the same as the one with Unix line breaks.
+    REQUIRE( mdb.getNumberOfMessages() == 3 );
+    REQUIRE_FALSE( mdb.hasMessage(pm) );
+    REQUIRE( mdb.hasMessage(unixPM) );
+    REQUIRE( mdb.hasMessage(other) );
+    REQUIRE_FALSE( mdb.hasMessage(otherCR) );
+    REQUIRE( mdb.hasMessage(otherUnix) );
+
+    // Folder entries move to the new hash, but do not replace existing ones.
+    REQUIRE_FALSE( fm.hasEntry(pm.getHash()) );
+    REQUIRE( fm.getFolderName(unixPM.getHash()) == "Inbox" );
+    REQUIRE_FALSE( fm.hasEntry(otherCR.getHash()) );
+    REQUIRE( fm.getFolderName(otherUnix.getHash()) == "Outbox" );
+    REQUIRE_FALSE( fm.hasEntry(other.getHash()) );
+
+    REQUIRE( mdb.normaliseMessages(changed, fm, 1) );
+    REQUIRE( changed == 0 );
+    REQUIRE( mdb.getNumberOfMessages() == 3 );
+  }
+
   SECTION("more than one message")
   {
     MessageDatabase mdb;
@@ -219,6 +307,133 @@ TEST_CASE("MessageDatabase")
       REQUIRE( fm.getFolderName(hash) == "Postausgang" );
     }
 
+    SECTION("import PMs from file without whitespace between elements")
+    {
+      constexpr std::string_view content = "<?xml version=\"1.0\" encoding=\"ISO-8859-1\"?>"
+          "<privatemessages><folder name=\"Posteingang\"><privatemessage>"
+          "<datestamp>2007-06-14 12:34</datestamp><title>Title &amp; more</title>"
+          "<fromuser>Alice</fromuser><fromuserid>2345</fromuserid><touser>Bob</touser>"
+          "<message><![CDATA[First part, ]]>second part</message>"
+          "</privatemessage><privatemessage>"
+          "<datestamp>2007-06-15 12:34</datestamp><title>Another title</title>"
+          "<fromuser>Bob</fromuser><fromuserid>3456</fromuserid><touser>Alice</touser>"
+          "<message>Reply</message>"
+          "</privatemessage></folder></privatemessages>";
+
+      const std::filesystem::path path{std::filesystem::temp_directory_path() / "pmdb_compact_messages.xml"};
+      REQUIRE( writeMessage(path, content) );
+      const FileGuard guard{path};
+
+      MessageDatabase mdb;
+      FolderMap fm;
+
+      REQUIRE( mdb.importFromFile(path.string(), read_messages, new_messages, fm) );
+      REQUIRE( read_messages == 2 );
+      REQUIRE( new_messages == 2 );
+      REQUIRE( mdb.getNumberOfMessages() == 2 );
+
+      bool foundFirst = false;
+      for (auto iter = mdb.getBegin(); iter != mdb.getEnd(); ++iter)
+      {
+        if (iter->second.getDatestamp() == "2007-06-14 12:34")
+        {
+          foundFirst = true;
+          REQUIRE( iter->second.getTitle() == "Title & more" );
+          REQUIRE( iter->second.getMessage() == "First part, second part" );
+        }
+        REQUIRE( fm.getFolderName(iter->first) == "Posteingang" );
+      }
+      REQUIRE( foundFirst );
+    }
+
+    SECTION("import with several jobs gives the same result")
+    {
+      // Messages repeat in other folders, so order and duplicates matter.
+      std::string content = "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<privatemessages>\n";
+      for (unsigned int folder = 0; folder < 3; ++folder)
+      {
+        content += "<folder name=\"Folder " + std::to_string(folder) + "\">\n";
+        for (unsigned int i = folder * 200; i < folder * 200 + 500; ++i)
+        {
+          content += "<privatemessage><datestamp>2007-06-14 12:34</datestamp>"
+                     "<title>Title " + std::to_string(i) + "</title>"
+                     "<fromuser>Alice</fromuser><fromuserid>2345</fromuserid>"
+                     "<touser>Bob</touser><message>Line one\r\nLine two of "
+                   + std::to_string(i) + "</message></privatemessage>\n";
+        }
+        content += "</folder>\n";
+      }
+      content += "</privatemessages>\n";
+
+      const std::filesystem::path path{std::filesystem::temp_directory_path() / "pmdb_pipeline_messages.xml"};
+      REQUIRE( writeMessage(path, content) );
+      const FileGuard guard{path};
+
+      MessageDatabase sequential;
+      FolderMap sequentialFolders;
+      REQUIRE( sequential.importFromFile(path.string(), read_messages, new_messages, sequentialFolders) );
+      REQUIRE( read_messages == 1500 );
+      REQUIRE( new_messages == 900 );
+
+      MessageDatabase pipelined;
+      FolderMap pipelinedFolders;
+      uint32_t pipelinedRead = 0;
+      uint32_t pipelinedNew = 0;
+      const unsigned int jobs = GENERATE(2, 4);
+      REQUIRE( pipelined.importFromFile(path.string(), pipelinedRead, pipelinedNew, pipelinedFolders, jobs) );
+      REQUIRE( pipelinedRead == read_messages );
+      REQUIRE( pipelinedNew == new_messages );
+      REQUIRE( pipelined.getNumberOfMessages() == sequential.getNumberOfMessages() );
+
+      auto seqIter = sequential.getBegin();
+      auto pipeIter = pipelined.getBegin();
+      while (seqIter != sequential.getEnd())
+      {
+        REQUIRE( pipeIter != pipelined.getEnd() );
+        REQUIRE( seqIter->first == pipeIter->first );
+        REQUIRE( seqIter->second == pipeIter->second );
+        REQUIRE( pipelinedFolders.getFolderName(pipeIter->first) == sequentialFolders.getFolderName(seqIter->first) );
+        ++seqIter;
+        ++pipeIter;
+      }
+    }
+
+    SECTION("failure: invalid message after valid ones, with several jobs")
+    {
+      constexpr std::string_view content = R"(<?xml version="1.0" encoding="ISO-8859-1"?>
+          <privatemessages>
+                  <folder name="Postausgang">
+                          <privatemessage>
+                                  <datestamp>2007-06-14 12:34</datestamp>
+                                  <title>This is a new title.</title>
+                                  <fromuser>Alice</fromuser>
+                                  <fromuserid>2345</fromuserid>
+                                  <touser>Bob</touser>
+                                  <message>This is a message.</message>
+                          </privatemessage>
+                          <privatemessage>
+                                  <datestamp>2007-06-14 12:35</datestamp>
+                                  <title>This is a new title.</title>
+                                  <fromuser>Alice</fromuser>
+                                  <fromuserid>2345</fromuserid>
+                                  <touser>Bob</touser>
+                          </privatemessage>
+                  </folder>
+          </privatemessages>)";
+
+      const std::filesystem::path path{std::filesystem::temp_directory_path() / "pmdb_pipeline_failure.xml"};
+      REQUIRE( writeMessage(path, content) );
+      const FileGuard guard{path};
+
+      MessageDatabase mdb;
+      FolderMap fm;
+
+      REQUIRE_FALSE( mdb.importFromFile(path.string(), read_messages, new_messages, fm, 3) );
+      REQUIRE( read_messages == 1 );
+      REQUIRE( new_messages == 1 );
+      REQUIRE( mdb.getNumberOfMessages() == 1 );
+    }
+
     SECTION("failure: XML cannot be parsed")
     {
       constexpr std::string_view content = R"(<?xml version="1.0" encoding="ISO-8859-1"?>
@@ -731,4 +946,487 @@ TEST_CASE("MessageDatabase")
       REQUIRE_FALSE( mdb.importFromFile(path.string(), read_messages, new_messages, fm) );
     }
   }
+
+  SECTION("saveMessages")
+  {
+    namespace fs = std::filesystem;
+
+    PrivateMessage pm;
+    pm.setDatestamp("2007-06-14 12:34");
+    pm.setTitle("This is the title");
+    pm.setFromUser("Hermes");
+    pm.setFromUserID(234);
+    pm.setToUser("Poseidon");
+    pm.setMessage("This is a message.");
+
+    PrivateMessage secondPM;
+    secondPM.setDatestamp("2007-06-14 12:34");
+    secondPM.setTitle("This is the title");
+    secondPM.setFromUser("Mr. A");
+    secondPM.setFromUserID(567890);
+    secondPM.setToUser("Mrs. B");
+    secondPM.setMessage("This is another message.");
+
+    const fs::path path{fs::temp_directory_path() / "pmdb_incremental_save"};
+    fs::remove_all(path);
+    REQUIRE( fs::create_directory(path) );
+    const fs::path firstFile = path / pm.getHash().toHexString();
+    const fs::path secondFile = path / secondPM.getHash().toHexString();
+
+    {
+      MessageDatabase mdb;
+      REQUIRE( mdb.addMessage(pm) );
+      REQUIRE( mdb.saveMessages(path.string(), Compression::none) );
+    }
+
+    SECTION("incremental save writes only messages not loaded from directory")
+    {
+      MessageDatabase mdb;
+      uint32_t read_messages = 0;
+      uint32_t new_messages = 0;
+      REQUIRE( mdb.loadMessages(path.string(), read_messages, new_messages, Compression::none) );
+      REQUIRE( read_messages == 1 );
+      REQUIRE( mdb.addMessage(secondPM) );
+
+      // Remove file of loaded message to see whether it gets written again.
+      REQUIRE( fs::remove(firstFile) );
+      REQUIRE( mdb.saveMessages(path.string(), Compression::none, 1, SaveMode::Incremental) );
+      REQUIRE_FALSE( fs::exists(firstFile) );
+      REQUIRE( fs::exists(secondFile) );
+
+      // Full save writes all messages.
+      REQUIRE( mdb.saveMessages(path.string(), Compression::none, 1, SaveMode::Full) );
+      REQUIRE( fs::exists(firstFile) );
+      REQUIRE( fs::exists(secondFile) );
+    }
+
+    SECTION("incremental save after saving with other compression writes all messages")
+    {
+      MessageDatabase mdb;
+      uint32_t read_messages = 0;
+      uint32_t new_messages = 0;
+      REQUIRE( mdb.loadMessages(path.string(), read_messages, new_messages, Compression::none) );
+      REQUIRE( read_messages == 1 );
+
+      REQUIRE( fs::remove(firstFile) );
+      REQUIRE( mdb.saveMessages(path.string(), Compression::zlib, 1, SaveMode::Incremental) );
+      REQUIRE( fs::exists(firstFile) );
+    }
+
+    fs::remove_all(path);
+  }
+
+  SECTION("message pack storage")
+  {
+    namespace fs = std::filesystem;
+
+    PrivateMessage pm;
+    pm.setDatestamp("2007-06-14 12:34");
+    pm.setTitle("This is the title");
+    pm.setFromUser("Hermes");
+    pm.setFromUserID(234);
+    pm.setToUser("Poseidon");
+    pm.setMessage("This is a message.");
+
+    PrivateMessage secondPM;
+    secondPM.setDatestamp("2007-06-14 12:34");
+    secondPM.setTitle("This is the title");
+    secondPM.setFromUser("Mr. A");
+    secondPM.setFromUserID(567890);
+    secondPM.setToUser("Mrs. B");
+    secondPM.setMessage("This is another message.");
+
+    const fs::path path{fs::temp_directory_path() / "pmdb_pack_storage"};
+    fs::remove_all(path);
+    REQUIRE( fs::create_directory(path) );
+    const fs::path firstFile = path / pm.getHash().toHexString();
+    const fs::path secondFile = path / secondPM.getHash().toHexString();
+    const fs::path packFile = path / pmdb::pack::packFileName;
+    const fs::path indexFile = path / pmdb::pack::indexFileName;
+
+    const auto compression = GENERATE(Compression::none, Compression::zlib);
+
+    // save first message as single file
+    {
+      MessageDatabase mdb;
+      REQUIRE( mdb.addMessage(pm) );
+      REQUIRE( mdb.saveMessages(path.string(), compression) );
+      REQUIRE( fs::exists(firstFile) );
+    }
+
+    // convert to pack and append second message
+    {
+      MessageDatabase mdb;
+      uint32_t read_messages = 0;
+      uint32_t new_messages = 0;
+      REQUIRE( mdb.loadMessages(path.string(), read_messages, new_messages, compression) );
+      REQUIRE( read_messages == 1 );
+      REQUIRE( mdb.saveMessages(path.string(), compression, 1, SaveMode::Incremental, Storage::Pack) );
+      REQUIRE( fs::exists(packFile) );
+      REQUIRE( fs::exists(indexFile) );
+      // single file has been removed after conversion
+      REQUIRE_FALSE( fs::exists(firstFile) );
+      const auto packSize = fs::file_size(packFile);
+
+      REQUIRE( mdb.addMessage(secondPM) );
+      REQUIRE( mdb.saveMessages(path.string(), compression, 2, SaveMode::Incremental, Storage::Pack) );
+      // new record is appended
+      REQUIRE( fs::file_size(packFile) > packSize );
+      REQUIRE_FALSE( fs::exists(secondFile) );
+    }
+
+    // load from pack
+    {
+      MessageDatabase mdb;
+      uint32_t read_messages = 0;
+      uint32_t new_messages = 0;
+      REQUIRE( mdb.loadMessages(path.string(), read_messages, new_messages, compression, 2) );
+      REQUIRE( read_messages == 2 );
+      REQUIRE( new_messages == 2 );
+      REQUIRE( mdb.hasMessage(pm) );
+      REQUIRE( mdb.hasMessage(secondPM) );
+      REQUIRE( mdb.getMessage(secondPM.getHash()) == secondPM );
+
+      // Convert back to single files.
+      REQUIRE( mdb.saveMessages(path.string(), compression, 1, SaveMode::Incremental, Storage::Directory) );
+      REQUIRE( fs::exists(firstFile) );
+      REQUIRE( fs::exists(secondFile) );
+      REQUIRE_FALSE( fs::exists(packFile) );
+      REQUIRE_FALSE( fs::exists(indexFile) );
+    }
+
+    // pack is kept, if not all of its messages are saved as files
+    {
+      MessageDatabase mdb;
+      REQUIRE( mdb.addMessage(pm) );
+      REQUIRE( mdb.addMessage(secondPM) );
+      REQUIRE( mdb.saveMessages(path.string(), compression, 1, SaveMode::Full, Storage::Pack) );
+      mdb.clear();
+      REQUIRE( mdb.addMessage(pm) );
+      REQUIRE( mdb.saveMessages(path.string(), compression, 1, SaveMode::Full, Storage::Directory) );
+      REQUIRE( fs::exists(packFile) );
+    }
+
+    // rewriting the pack keeps messages which have not been loaded
+    {
+      const auto newCompression = GENERATE(Compression::none, Compression::zlib);
+      fs::remove(firstFile);
+      fs::remove(secondFile);
+      MessageDatabase mdb;
+      REQUIRE( mdb.addMessage(pm) );
+      REQUIRE( mdb.addMessage(secondPM) );
+      REQUIRE( mdb.saveMessages(path.string(), compression, 1, SaveMode::Full, Storage::Pack) );
+      mdb.clear();
+      REQUIRE( mdb.addMessage(secondPM) );
+      REQUIRE( mdb.saveMessages(path.string(), newCompression, 2, SaveMode::Full, Storage::Pack) );
+
+      MessageDatabase loaded;
+      uint32_t read_messages = 0;
+      uint32_t new_messages = 0;
+      REQUIRE( loaded.loadMessages(path.string(), read_messages, new_messages, newCompression) );
+      REQUIRE( read_messages == 2 );
+      REQUIRE( loaded.getMessage(pm.getHash()) == pm );
+      REQUIRE( loaded.getMessage(secondPM.getHash()) == secondPM );
+    }
+
+    // old pack and index stay intact, if the new index cannot be written
+    {
+      fs::remove(firstFile);
+      fs::remove(secondFile);
+      REQUIRE( pmdb::pack::remove(path.string()) );
+      MessageDatabase mdb;
+      REQUIRE( mdb.addMessage(pm) );
+      REQUIRE( mdb.saveMessages(path.string(), compression, 1, SaveMode::Full, Storage::Pack) );
+      const auto packSize = fs::file_size(packFile);
+
+      // A directory in place of the temporary index lets writing it fail.
+      const fs::path tempIndex = path / (pmdb::pack::indexFileName + ".tmp");
+      REQUIRE( fs::create_directory(tempIndex) );
+      mdb.clear();
+      REQUIRE( mdb.addMessage(secondPM) );
+      REQUIRE_FALSE( mdb.saveMessages(path.string(), compression, 1, SaveMode::Full, Storage::Pack) );
+      fs::remove(tempIndex);
+      REQUIRE( fs::file_size(packFile) == packSize );
+      REQUIRE_FALSE( fs::exists(path / (pmdb::pack::packFileName + ".tmp")) );
+
+      MessageDatabase loaded;
+      uint32_t read_messages = 0;
+      uint32_t new_messages = 0;
+      REQUIRE( loaded.loadMessages(path.string(), read_messages, new_messages, compression) );
+      REQUIRE( read_messages == 1 );
+      REQUIRE( loaded.getMessage(pm.getHash()) == pm );
+    }
+
+    fs::remove_all(path);
+  }
+
+  SECTION("normaliseMessages with saved messages")
+  {
+    namespace fs = std::filesystem;
+
+    PrivateMessage pm;
+    pm.setDatestamp("2007-06-14 12:34");
+    pm.setTitle("This is the title");
+    pm.setFromUser("Hermes");
+    pm.setFromUserID(234);
+    pm.setToUser("Poseidon");
+    pm.setMessage("Line one.\r\nLine two.");
+    PrivateMessage unixPM = pm;
+    unixPM.setMessage("Line one.\nLine two.");
+    PrivateMessage other = pm;
+    other.setMessage("Nothing to change here.");
+
+    const fs::path path{fs::temp_directory_path() / "pmdb_normalise_saved"};
+    fs::remove_all(path);
+    REQUIRE( fs::create_directory(path) );
+    const fs::path oldFile = path / pm.getHash().toHexString();
+    const fs::path newFile = path / unixPM.getHash().toHexString();
+
+    const auto storage = GENERATE(Storage::Directory, Storage::Pack);
+
+    {
+      MessageDatabase mdb;
+      REQUIRE( mdb.addMessage(pm) );
+      REQUIRE( mdb.addMessage(other) );
+      REQUIRE( mdb.saveMessages(path.string(), Compression::none, 1, SaveMode::Incremental, storage) );
+    }
+
+    {
+      MessageDatabase mdb;
+      uint32_t read_messages = 0;
+      uint32_t new_messages = 0;
+      REQUIRE( mdb.loadMessages(path.string(), read_messages, new_messages, Compression::none, 1, Verification::Full, LoadMode::Headers) );
+      REQUIRE( read_messages == 2 );
+
+      FolderMap fm;
+      std::size_t changed = 0;
+      REQUIRE( mdb.normaliseMessages(changed, fm, 2) );
+      REQUIRE( changed == 1 );
+      // The incremental save has to write the new message and drop the old one.
+      REQUIRE( mdb.saveMessages(path.string(), Compression::none, 1, SaveMode::Incremental, storage) );
+      REQUIRE_FALSE( fs::exists(oldFile) );
+      REQUIRE( fs::exists(newFile) == (storage == Storage::Directory) );
+    }
+
+    MessageDatabase loaded;
+    uint32_t read_messages = 0;
+    uint32_t new_messages = 0;
+    REQUIRE( loaded.loadMessages(path.string(), read_messages, new_messages, Compression::none) );
+    REQUIRE( read_messages == 2 );
+    REQUIRE( loaded.hasMessage(unixPM) );
+    REQUIRE( loaded.hasMessage(other) );
+    REQUIRE_FALSE( loaded.hasMessage(pm) );
+
+    fs::remove_all(path);
+  }
+
+  SECTION("loadMessages verification")
+  {
+    namespace fs = std::filesystem;
+
+    PrivateMessage pm;
+    pm.setDatestamp("2007-06-14 12:34");
+    pm.setTitle("This is the title");
+    pm.setFromUser("Hermes");
+    pm.setFromUserID(234);
+    pm.setToUser("Poseidon");
+    pm.setMessage("This is a message.");
+
+    const fs::path path{fs::temp_directory_path() / "pmdb_load_verification"};
+    fs::remove_all(path);
+    REQUIRE( fs::create_directory(path) );
+    const fs::path file = path / pm.getHash().toHexString();
+    const fs::path cacheFile = path / pmdb::verification::cacheFileName;
+
+    {
+      MessageDatabase mdb;
+      REQUIRE( mdb.addMessage(pm) );
+      REQUIRE( mdb.saveMessages(path.string(), Compression::none) );
+    }
+
+    // Changes the message text in the file without changing the file size or
+    // the modification time.
+    const auto alterFile = [&]()
+    {
+      const auto modified = fs::last_write_time(file);
+      std::string content;
+      {
+        std::ifstream stream(file, std::ios::in | std::ios::binary);
+        content.assign(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+      }
+      const auto pos = content.find("message.");
+      REQUIRE( pos != std::string::npos );
+      content[pos] = 'M';
+      REQUIRE( writeMessage(file, content) );
+      fs::last_write_time(file, modified);
+    };
+
+    uint32_t read_messages = 0;
+    uint32_t new_messages = 0;
+
+    SECTION("full verification detects altered files")
+    {
+      alterFile();
+      MessageDatabase mdb;
+      REQUIRE_FALSE( mdb.loadMessages(path.string(), read_messages, new_messages, Compression::none, 1, Verification::Full) );
+      REQUIRE( read_messages == 0 );
+      REQUIRE_FALSE( fs::exists(cacheFile) );
+    }
+
+    SECTION("no verification trusts the file names")
+    {
+      alterFile();
+      MessageDatabase mdb;
+      REQUIRE( mdb.loadMessages(path.string(), read_messages, new_messages, Compression::none, 2, Verification::None) );
+      REQUIRE( read_messages == 1 );
+      REQUIRE( mdb.getNumberOfMessages() == 1 );
+      REQUIRE( mdb.getBegin()->first == pm.getHash() );
+      REQUIRE_FALSE( fs::exists(cacheFile) );
+    }
+
+    SECTION("verified files are not hashed again while unchanged")
+    {
+      {
+        MessageDatabase mdb;
+        REQUIRE( mdb.loadMessages(path.string(), read_messages, new_messages, Compression::none) );
+        REQUIRE( read_messages == 1 );
+      }
+      REQUIRE( fs::exists(cacheFile) );
+
+      // Same size and modification time, so the cached result is used.
+      alterFile();
+      {
+        MessageDatabase mdb;
+        REQUIRE( mdb.loadMessages(path.string(), read_messages, new_messages, Compression::none) );
+        REQUIRE( read_messages == 1 );
+      }
+
+      // Another modification time means that the file is hashed again.
+      fs::last_write_time(file, fs::last_write_time(file) + std::chrono::seconds(10));
+      {
+        MessageDatabase mdb;
+        REQUIRE_FALSE( mdb.loadMessages(path.string(), read_messages, new_messages, Compression::none) );
+      }
+    }
+
+    fs::remove_all(path);
+  }
+
+  SECTION("loadMessages with headers only")
+  {
+    namespace fs = std::filesystem;
+
+    PrivateMessage pm;
+    pm.setDatestamp("2007-06-14 12:34");
+    pm.setTitle("This is the title");
+    pm.setFromUser("Hermes");
+    pm.setFromUserID(234);
+    pm.setToUser("Poseidon");
+    pm.setMessage("This is a message.");
+
+    PrivateMessage secondPM;
+    secondPM.setDatestamp("2007-06-14 12:35");
+    secondPM.setTitle("This is another title");
+    secondPM.setFromUser("Mr. A");
+    secondPM.setFromUserID(567890);
+    secondPM.setToUser("Mrs. B");
+    secondPM.setMessage("This is another message.");
+
+    const fs::path path{fs::temp_directory_path() / "pmdb_load_headers"};
+    const fs::path copyPath{fs::temp_directory_path() / "pmdb_load_headers_copy"};
+    fs::remove_all(path);
+    fs::remove_all(copyPath);
+    REQUIRE( fs::create_directory(path) );
+    REQUIRE( fs::create_directory(copyPath) );
+
+    const auto compression = GENERATE(Compression::none, Compression::zlib);
+    const auto storage = GENERATE(Storage::Directory, Storage::Pack);
+    {
+      MessageDatabase mdb;
+      REQUIRE( mdb.addMessage(pm) );
+      REQUIRE( mdb.addMessage(secondPM) );
+      REQUIRE( mdb.saveMessages(path.string(), compression, 1, SaveMode::Full, storage) );
+    }
+
+    MessageDatabase mdb;
+    uint32_t read_messages = 0;
+    uint32_t new_messages = 0;
+    REQUIRE( mdb.loadMessages(path.string(), read_messages, new_messages, compression, 2, Verification::Full, LoadMode::Headers) );
+    REQUIRE( read_messages == 2 );
+    for (auto iter = mdb.getBegin(); iter != mdb.getEnd(); ++iter)
+    {
+      REQUIRE_FALSE( iter->second.isMessageLoaded() );
+    }
+    REQUIRE( mdb.getMessage(pm.getHash()).getTitle() == pm.getTitle() );
+    REQUIRE_FALSE( mdb.getMessage(pm.getHash()).isMessageLoaded() );
+
+    // Texts are read when they are needed.
+    REQUIRE( mdb.getMessage(pm.getHash()).getMessage() == pm.getMessage() );
+    REQUIRE( mdb.getMessage(pm.getHash()).isMessageLoaded() );
+
+    // Saving to another directory reads the remaining texts.
+    REQUIRE( mdb.saveMessages(copyPath.string(), compression, 2) );
+    MessageDatabase copy;
+    REQUIRE( copy.loadMessages(copyPath.string(), read_messages, new_messages, compression) );
+    REQUIRE( read_messages == 2 );
+    REQUIRE( copy.getMessage(secondPM.getHash()) == secondPM );
+
+    fs::remove_all(path);
+    fs::remove_all(copyPath);
+  }
+
+  SECTION("saveIndexFiles")
+  {
+    namespace fs = std::filesystem;
+    const fs::path path{fs::temp_directory_path() / "pmdb_index_files"};
+    fs::remove_all(path);
+    REQUIRE( fs::create_directory(path) );
+
+    MessageDatabase mdb;
+    FolderMap fm;
+    const auto addMessage = [&mdb, &fm](const std::string& date, const std::string& title, const std::string& folder)
+    {
+      PrivateMessage pm;
+      pm.setDatestamp(date);
+      pm.setTitle(title);
+      pm.setFromUser("Hermes");
+      pm.setFromUserID(234);
+      pm.setToUser("Poseidon");
+      pm.setMessage("Text of " + title);
+      if (!folder.empty())
+        fm.add(pm.getHash(), folder);
+      REQUIRE( mdb.addMessage(pm) );
+      return pm.getHash().toHexString();
+    };
+    const auto old_inbox = addMessage("2007-06-14 12:34", "old", "Inbox");
+    const auto new_inbox = addMessage("2008-01-01 00:00", "new", "Inbox");
+    const auto outbox = addMessage("2007-07-01 08:15", "sent <1>", "Outbox");
+    const auto without = addMessage("2007-01-01 10:00", "no folder", "");
+
+    MsgTemplate index("{..folders..}|{..entries..}");
+    MsgTemplate entry("[{..date..} {..pm_url..} {..title..}]");
+    MsgTemplate folderList("({..folder_entries..})");
+    MsgTemplate folderEntry("<{..marker..}{..folder_name..}>");
+    REQUIRE( mdb.saveIndexFiles(path.string() + "/", index, entry, folderList, folderEntry, fm, HTMLStandard::HTML4_01) );
+
+    const auto readFile = [](const fs::path& file)
+    {
+      std::ifstream stream(file, std::ios::in | std::ios::binary);
+      return std::string(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+    };
+    const std::string hidden = "<span style=\"visibility: hidden;\">&#x2714;</span>";
+    const std::string folders = "(<" + hidden + "Inbox><" + hidden + "Outbox>)";
+    REQUIRE( readFile(path / "index.html") == folders + "|[2007-01-01 10:00 " + without + ".html no folder]" );
+
+    const std::string inbox_file = "folder_" + pmdb::sha256::computeFromString("Inbox").toHexString() + ".html";
+    REQUIRE( readFile(path / inbox_file) ==
+             "(<&#x2714;Inbox><" + hidden + "Outbox>)|[2008-01-01 00:00 " + new_inbox
+             + ".html new][2007-06-14 12:34 " + old_inbox + ".html old]" );
+
+    const std::string outbox_file = "folder_" + pmdb::sha256::computeFromString("Outbox").toHexString() + ".html";
+    REQUIRE( readFile(path / outbox_file) ==
+             "(<" + hidden + "Inbox><&#x2714;Outbox>)|[2007-07-01 08:15 " + outbox + ".html sent &lt;1&gt;]" );
+
+    fs::remove_all(path);
+  }
 }
@@ -0,0 +1,186 @@
+/*
+ -------------------------------------------------------------------------------
+    This file is part of the Private Message Database test suite.
+    Copyright (C) 2026  Dirk Stolle
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ -------------------------------------------------------------------------------
+*/
+
+#include "../locate_catch.hpp"
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include "../../code/MessagePack.hpp"
+
+TEST_CASE("message pack")
+{
+  namespace fs = std::filesystem;
+  using namespace pmdb::pack;
+
+  SECTION("header")
+  {
+    SECTION("uncompressed")
+    {
+      std::stringstream stream;
+      REQUIRE( writeHeader(stream, Compression::none) );
+      REQUIRE( stream.str().size() == headerSize );
+
+      Compression compression = Compression::zlib;
+      REQUIRE( readHeader(stream, compression) );
+      REQUIRE( compression == Compression::none );
+    }
+
+    SECTION("compressed")
+    {
+      std::stringstream stream;
+      REQUIRE( writeHeader(stream, Compression::zlib) );
+
+      Compression compression = Compression::none;
+      REQUIRE( readHeader(stream, compression) );
+      REQUIRE( compression == Compression::zlib );
+    }
+
+    SECTION("wrong magic bytes")
+    {
+      std::stringstream stream;
+      stream << "This is not a pack file header.";
+
+      Compression compression = Compression::none;
+      REQUIRE_FALSE( readHeader(stream, compression) );
+    }
+
+    SECTION("truncated header")
+    {
+      std::stringstream stream;
+      REQUIRE( writeHeader(stream, Compression::zlib) );
+      std::stringstream truncated(stream.str().substr(0, 10));
+
+      Compression compression = Compression::none;
+      REQUIRE_FALSE( readHeader(truncated, compression) );
+    }
+  }
+
+  SECTION("index")
+  {
+    const fs::path path{fs::temp_directory_path() / "pmdb_pack_index"};
+    fs::remove_all(path);
+    REQUIRE( fs::create_directory(path) );
+
+    SHA256::MessageDigest first;
+    REQUIRE( first.fromHexString("1111111111111111111111111111111111111111111111111111111111111111") );
+    SHA256::MessageDigest second;
+    REQUIRE( second.fromHexString("2222222222222222222222222222222222222222222222222222222222222222") );
+    SHA256::MessageDigest third;
+    REQUIRE( third.fromHexString("3333333333333333333333333333333333333333333333333333333333333333") );
+
+    SECTION("write and read index")
+    {
+      std::vector<IndexEntry> entries;
+      entries.push_back({ first, headerSize, 100 });
+      entries.push_back({ third, headerSize + 100, 42 });
+      REQUIRE( writeIndex(path.string(), entries) );
+
+      std::vector<IndexEntry> read;
+      REQUIRE( readIndex(path.string(), read) );
+      REQUIRE( read.size() == 2 );
+      REQUIRE( read[0].digest == first );
+      REQUIRE( read[0].offset == headerSize );
+      REQUIRE( read[0].size == 100 );
+      REQUIRE( read[1].digest == third );
+      REQUIRE( read[1].offset == headerSize + 100 );
+      REQUIRE( read[1].size == 42 );
+
+      REQUIRE( contains(read, first) );
+      REQUIRE_FALSE( contains(read, second) );
+      REQUIRE( contains(read, third) );
+    }
+
+    SECTION("empty index")
+    {
+      REQUIRE( writeIndex(path.string(), {}) );
+
+      std::vector<IndexEntry> read;
+      REQUIRE( readIndex(path.string(), read) );
+      REQUIRE( read.empty() );
+      REQUIRE_FALSE( contains(read, first) );
+    }
+
+    SECTION("unsorted index is rejected")
+    {
+      std::vector<IndexEntry> entries;
+      entries.push_back({ third, headerSize, 100 });
+      entries.push_back({ first, headerSize + 100, 42 });
+      REQUIRE( writeIndex(path.string(), entries) );
+
+      std::vector<IndexEntry> read;
+      REQUIRE_FALSE( readIndex(path.string(), read) );
+    }
+
+    SECTION("prepared index replaces the index only when committed")
+    {
+      REQUIRE( writeIndex(path.string(), { { first, headerSize, 100 } }) );
+      REQUIRE( prepareIndex(path.string(), { { second, headerSize, 42 } }) );
+
+      std::vector<IndexEntry> read;
+      REQUIRE( readIndex(path.string(), read) );
+      REQUIRE( read.size() == 1 );
+      REQUIRE( read[0].digest == first );
+
+      REQUIRE( commitIndex(path.string()) );
+      REQUIRE( readIndex(path.string(), read) );
+      REQUIRE( read.size() == 1 );
+      REQUIRE( read[0].digest == second );
+
+      // nothing left to commit
+      REQUIRE_FALSE( commitIndex(path.string()) );
+    }
+
+    SECTION("discarded index is not committed")
+    {
+      REQUIRE( writeIndex(path.string(), { { first, headerSize, 100 } }) );
+      REQUIRE( prepareIndex(path.string(), { { second, headerSize, 42 } }) );
+      discardIndex(path.string());
+      REQUIRE_FALSE( commitIndex(path.string()) );
+
+      std::vector<IndexEntry> read;
+      REQUIRE( readIndex(path.string(), read) );
+      REQUIRE( read.size() == 1 );
+      REQUIRE( read[0].digest == first );
+    }
+
+    SECTION("missing index")
+    {
+      std::vector<IndexEntry> read;
+      REQUIRE_FALSE( readIndex(path.string(), read) );
+    }
+
+    SECTION("exists and remove")
+    {
+      REQUIRE_FALSE( exists(path.string()) );
+      {
+        std::ofstream stream(path / packFileName, std::ios::out | std::ios::binary);
+        REQUIRE( writeHeader(stream, Compression::none) );
+      }
+      REQUIRE( writeIndex(path.string(), {}) );
+      REQUIRE( exists(path.string()) );
+
+      REQUIRE( remove(path.string()) );
+      REQUIRE_FALSE( exists(path.string()) );
+      REQUIRE_FALSE( fs::exists(path / indexFileName) );
+    }
+
+    fs::remove_all(path);
+  }
+}
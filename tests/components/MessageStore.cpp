@@ -0,0 +1,133 @@
+/*
+ -------------------------------------------------------------------------------
+    This file is part of the Private Message Database.
+    Copyright (C) 2026  Dirk Stolle
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ -------------------------------------------------------------------------------
+*/
+
+#include "../locate_catch.hpp"
+#include <algorithm>
+#include <string>
+#include <vector>
+#include "../../code/MessageStore.hpp"
+
+PrivateMessage createMessage(const unsigned int number)
+{
+  PrivateMessage pm;
+  pm.setDatestamp("2007-06-14 12:34");
+  pm.setTitle("Message " + std::to_string(number));
+  pm.setFromUser("Hermes");
+  pm.setFromUserID(234);
+  pm.setToUser("Poseidon");
+  pm.setMessage("This is message number " + std::to_string(number) + ".");
+  return pm;
+}
+
+TEST_CASE("MessageStore")
+{
+  SECTION("empty store")
+  {
+    MessageStore store;
+    REQUIRE( store.empty() );
+    REQUIRE( store.size() == 0 );
+    REQUIRE( store.begin() == store.end() );
+    PrivateMessage pm = createMessage(1);
+    REQUIRE( store.find(pm.getHash()) == nullptr );
+    REQUIRE_FALSE( store.contains(pm.getHash()) );
+  }
+
+  SECTION("insert and find")
+  {
+    MessageStore store;
+    PrivateMessage pm = createMessage(1);
+    REQUIRE( store.insert(pm.getHash(), pm) );
+    REQUIRE( store.size() == 1 );
+    REQUIRE( store.contains(pm.getHash()) );
+    REQUIRE( store.find(pm.getHash()) != nullptr );
+    REQUIRE( *store.find(pm.getHash()) == pm );
+
+    // second insert with same digest is rejected
+    PrivateMessage other = createMessage(2);
+    REQUIRE_FALSE( store.insert(pm.getHash(), other) );
+    REQUIRE( store.size() == 1 );
+    REQUIRE( *store.find(pm.getHash()) == pm );
+  }
+
+  SECTION("digests with same prefix")
+  {
+    MessageStore store;
+    SHA256::MessageDigest first;
+    REQUIRE( first.fromHexString("1111111111111111000000000000000000000000000000000000000000000000") );
+    SHA256::MessageDigest second;
+    REQUIRE( second.fromHexString("1111111111111111000000000000000000000000000000000000000000000001") );
+    REQUIRE( store.insert(first, createMessage(1)) );
+    REQUIRE( store.insert(second, createMessage(2)) );
+    REQUIRE( store.size() == 2 );
+    REQUIRE( store.find(first)->getTitle() == "Message 1" );
+    REQUIRE( store.find(second)->getTitle() == "Message 2" );
+  }
+
+  SECTION("many messages, iteration in digest order")
+  {
+    MessageStore store;
+    std::vector<SHA256::MessageDigest> digests;
+    for (unsigned int i = 0; i < 1000; ++i)
+    {
+      PrivateMessage pm = createMessage(i);
+      digests.push_back(pm.getHash());
+      REQUIRE( store.insert(pm.getHash(), pm) );
+      // iteration in between updates the sorted order incrementally
+      if (i % 300 == 0)
+      {
+        REQUIRE( std::distance(store.begin(), store.end()) == static_cast<std::ptrdiff_t>(i + 1) );
+      }
+    }
+    REQUIRE( store.size() == 1000 );
+
+    for (unsigned int i = 0; i < 1000; ++i)
+    {
+      const PrivateMessage* pm = store.find(digests[i]);
+      REQUIRE( pm != nullptr );
+      REQUIRE( pm->getTitle() == "Message " + std::to_string(i) );
+    }
+
+    std::sort(digests.begin(), digests.end());
+    auto iter = store.begin();
+    for (const auto& digest: digests)
+    {
+      REQUIRE( iter != store.end() );
+      REQUIRE( iter->first == digest );
+      ++iter;
+    }
+    REQUIRE( iter == store.end() );
+  }
+
+  SECTION("reserve and clear")
+  {
+    MessageStore store;
+    store.reserve(100);
+    PrivateMessage pm = createMessage(1);
+    REQUIRE( store.insert(pm.getHash(), pm) );
+    REQUIRE( store.begin() != store.end() );
+
+    store.clear();
+    REQUIRE( store.empty() );
+    REQUIRE( store.begin() == store.end() );
+    REQUIRE_FALSE( store.contains(pm.getHash()) );
+    REQUIRE( store.insert(pm.getHash(), pm) );
+    REQUIRE( store.size() == 1 );
+  }
+}
@@ -1,7 +1,7 @@
 /*
  -------------------------------------------------------------------------------
     This file is part of the Private Message Database test suite.
-    Copyright (C) 2015, 2025  Dirk Stolle
+    Copyright (C) 2015, 2025, 2026  Dirk Stolle
 
     This program is free software: you can redistribute it and/or modify
     it under the terms of the GNU General Public License as published by
@@ -19,7 +19,14 @@
 */
 
 #include "../locate_catch.hpp"
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
 #include "../../code/PrivateMessage.hpp"
+#include "../../libstriezel/hash/sha256/BufferSourceUtility.hpp"
 
 TEST_CASE("PrivateMessage")
 {
@@ -139,6 +146,47 @@ TEST_CASE("PrivateMessage")
                                  + "no sea takimata sanctus est Lorem ipsum dolor sit amet.";
       REQUIRE( pm.getMessage() == expected );
     }
+
+    SECTION("lone carriage returns stay, return value tells about changes")
+    {
+      pm.setMessage("\rA\r\r\nB\n\rC\r\n");
+      REQUIRE( pm.normalise() );
+      REQUIRE( pm.getMessage() == "\rA\r\nB\n\rC\n" );
+      pm.setMessage("\rA\n\rB\r");
+      REQUIRE_FALSE( pm.normalise() );
+      REQUIRE( pm.getMessage() == "\rA\n\rB\r" );
+    }
+  }
+
+  SECTION("getHash")
+  {
+    PrivateMessage pm;
+    pm.setDatestamp("2007-06-14 12:34");
+    pm.setTitle("This is the title");
+    pm.setFromUser("Hermes");
+    pm.setFromUserID(234);
+    pm.setToUser("Poseidon");
+    pm.setMessage("Hello!");
+
+    SECTION("known digest")
+    {
+      REQUIRE( pm.getHash().toHexString() == "e9cff852c2330bdd8a9d19c781d073e1b5bdafdc0e178a9fccdd53e74f103b6a" );
+    }
+
+    SECTION("same as hash of concatenated fields for all padding cases")
+    {
+      // The length of the data goes through several multiples of 64 bytes,
+      // covering every position of the end of the data in the last block.
+      for (std::size_t length = 1; length <= 200; ++length)
+      {
+        pm.setMessage(std::string(length, 'x'));
+        std::string data = std::string("2007-06-14 12:34\0This is the title\0Hermes\0", 42)
+                         + std::string("234\0Poseidon\0", 13) + pm.getMessage();
+        data.push_back('\0');
+        const auto expected = SHA256::computeFromBuffer(reinterpret_cast<uint8_t*>(data.data()), data.size() * 8);
+        REQUIRE( pm.getHash() == expected );
+      }
+    }
   }
 
   SECTION("loadFromFile")
@@ -152,6 +200,67 @@ TEST_CASE("PrivateMessage")
     }
   }
 
+  SECTION("loadFromBuffer")
+  {
+    using namespace std::string_view_literals;
+
+    PrivateMessage pm;
+
+    SECTION("valid buffer")
+    {
+      const std::string_view data = "2007-06-14 12:34\0Title\0Hermes\0" "234\0Poseidon\0Hello!\0"sv;
+      REQUIRE( pm.loadFromBuffer(data.data(), data.size(), Compression::none) );
+      REQUIRE( pm.getDatestamp() == "2007-06-14 12:34" );
+      REQUIRE( pm.getTitle() == "Title" );
+      REQUIRE( pm.getFromUser() == "Hermes" );
+      REQUIRE( pm.getFromUserID() == 234 );
+      REQUIRE( pm.getToUser() == "Poseidon" );
+      REQUIRE( pm.getMessage() == "Hello!" );
+    }
+
+    SECTION("round trip with saveToBuffer")
+    {
+      PrivateMessage original;
+      original.setDatestamp("2007-06-14 12:34");
+      original.setTitle("This is the title");
+      original.setFromUser("Hermes");
+      original.setFromUserID(234);
+      original.setToUser("Poseidon");
+      original.setMessage("Hello!\nThis is a message.");
+
+      const auto compression = GENERATE(Compression::none, Compression::zlib);
+      std::string data;
+      REQUIRE( original.saveToBuffer(data, compression) );
+      REQUIRE( pm.loadFromBuffer(data.c_str(), data.size(), compression) );
+      REQUIRE( pm == original );
+      REQUIRE( pm.getHash() == original.getHash() );
+    }
+
+    SECTION("failure: empty buffer")
+    {
+      REQUIRE_FALSE( pm.loadFromBuffer(nullptr, 0, Compression::none) );
+      REQUIRE_FALSE( pm.loadFromBuffer(nullptr, 0, Compression::zlib) );
+    }
+
+    SECTION("failure: last field is not terminated")
+    {
+      const std::string_view data = "2007-06-14 12:34\0Title\0Hermes\0" "234\0Poseidon\0Hello!"sv;
+      REQUIRE_FALSE( pm.loadFromBuffer(data.data(), data.size(), Compression::none) );
+    }
+
+    SECTION("failure: missing fields")
+    {
+      const std::string_view data = "2007-06-14 12:34\0Title\0Hermes\0"sv;
+      REQUIRE_FALSE( pm.loadFromBuffer(data.data(), data.size(), Compression::none) );
+    }
+
+    SECTION("failure: user ID is not numeric")
+    {
+      const std::string_view data = "2007-06-14 12:34\0Title\0Hermes\0abc\0Poseidon\0Hello!\0"sv;
+      REQUIRE_FALSE( pm.loadFromBuffer(data.data(), data.size(), Compression::none) );
+    }
+  }
+
   SECTION("saveToFile")
   {
     PrivateMessage pm;
@@ -168,4 +277,97 @@ TEST_CASE("PrivateMessage")
       REQUIRE_FALSE( pm.saveToFile("/does/not/exist/message.txt", Compression::zlib) );
     }
   }
+
+  SECTION("releaseMessage")
+  {
+    namespace fs = std::filesystem;
+
+    PrivateMessage original;
+    original.setDatestamp("2007-06-14 12:34");
+    original.setTitle("This is the title");
+    original.setFromUser("Hermes");
+    original.setFromUserID(234);
+    original.setToUser("Poseidon");
+    original.setMessage("Hello!\nThis is a message.");
+    const auto digest = original.getHash();
+
+    const fs::path directory{fs::temp_directory_path() / "pmdb_release_message"};
+    fs::remove_all(directory);
+    REQUIRE( fs::create_directory(directory) );
+    const auto sharedDirectory = std::make_shared<const std::string>((directory / "").string());
+    const fs::path path = directory / digest.toHexString();
+    const auto compression = GENERATE(Compression::none, Compression::zlib);
+
+    SECTION("text is read again from the message file")
+    {
+      REQUIRE( original.saveToFile(path.string(), compression) );
+
+      PrivateMessage pm;
+      REQUIRE( pm.loadFromFile(path.string(), compression) );
+      pm.releaseMessage({ sharedDirectory, 0, 0, compression, digest });
+      REQUIRE_FALSE( pm.isMessageLoaded() );
+      REQUIRE( pm.getTitle() == "This is the title" );
+      REQUIRE_FALSE( pm.isMessageLoaded() );
+
+      REQUIRE( pm.getMessage() == "Hello!\nThis is a message." );
+      REQUIRE( pm.isMessageLoaded() );
+      REQUIRE( pm == original );
+      REQUIRE( pm.getHash() == digest );
+    }
+
+    SECTION("text is read again from a part of a file")
+    {
+      std::string data;
+      REQUIRE( original.saveToBuffer(data, compression) );
+      {
+        std::ofstream stream(path, std::ios::out | std::ios::binary);
+        stream << "prefix";
+        stream.write(data.c_str(), data.size());
+        stream << "suffix";
+      }
+
+      PrivateMessage pm;
+      REQUIRE( pm.loadFromBuffer(data.c_str(), data.size(), compression) );
+      pm.releaseMessage({ std::make_shared<const std::string>(path.string()), 6, static_cast<std::uint32_t>(data.size()), compression, digest });
+      REQUIRE_FALSE( pm.isMessageLoaded() );
+
+      // saving reads the text again
+      std::string saved;
+      REQUIRE( pm.saveToBuffer(saved, compression) );
+      REQUIRE( saved == data );
+      REQUIRE( pm.isMessageLoaded() );
+    }
+
+    SECTION("failure: file has been removed or changed")
+    {
+      REQUIRE( original.saveToFile(path.string(), compression) );
+      PrivateMessage pm = original;
+      pm.releaseMessage({ sharedDirectory, 0, 0, compression, digest });
+
+      PrivateMessage other = original;
+      other.setTitle("Another title");
+      REQUIRE( other.saveToFile(path.string(), compression) );
+      REQUIRE_THROWS_AS( pm.getMessage(), std::runtime_error );
+
+      fs::remove(path);
+      REQUIRE_THROWS_AS( pm.getMessage(), std::runtime_error );
+      std::string data;
+      REQUIRE_FALSE( pm.saveToBuffer(data, compression) );
+    }
+
+    SECTION("failure: only the text has been changed")
+    {
+      REQUIRE( original.saveToFile(path.string(), compression) );
+      PrivateMessage pm = original;
+      pm.releaseMessage({ sharedDirectory, 0, 0, compression, digest });
+
+      PrivateMessage other = original;
+      other.setMessage("Hello!\nThis is another message.");
+      REQUIRE( other.saveToFile(path.string(), compression) );
+      REQUIRE_THROWS_AS( pm.getMessage(), std::runtime_error );
+      REQUIRE_FALSE( pm.isMessageLoaded() );
+    }
+
+    fs::remove_all(directory);
+  }
 }
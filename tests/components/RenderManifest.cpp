@@ -0,0 +1,111 @@
+/*
+ -------------------------------------------------------------------------------
+    This file is part of the Private Message Database.
+    Copyright (C) 2026  Dirk Stolle
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ -------------------------------------------------------------------------------
+*/
+
+#include "../locate_catch.hpp"
+#include <filesystem>
+#include "../../code/RenderManifest.hpp"
+
+TEST_CASE("render manifest")
+{
+  namespace fs = std::filesystem;
+  using namespace pmdb::manifest;
+
+  const fs::path path{fs::temp_directory_path() / "pmdb_render_manifest"};
+  fs::remove_all(path);
+  REQUIRE( fs::create_directory(path) );
+
+  SHA256::MessageDigest first;
+  REQUIRE( first.fromHexString("1111111111111111111111111111111111111111111111111111111111111111") );
+  SHA256::MessageDigest second;
+  REQUIRE( second.fromHexString("2222222222222222222222222222222222222222222222222222222222222222") );
+
+  const std::vector<Smilie> smilies = { Smilie(":)", "smile.gif", UrlType::Relative) };
+  Manifest manifest;
+  manifest.fingerprint = fingerprint("{..message..}", HTMLOptions(), "https://forum.example.com/", smilies);
+  manifest.digests = { first, second };
+
+  SECTION("write and read manifest")
+  {
+    REQUIRE( writeManifest(path.string(), manifest) );
+    REQUIRE( fs::exists(path / manifestFileName) );
+
+    Manifest read;
+    REQUIRE( readManifest(path.string(), read) );
+    REQUIRE( read.fingerprint == manifest.fingerprint );
+    REQUIRE( read.digests == manifest.digests );
+  }
+
+  SECTION("missing manifest")
+  {
+    Manifest read;
+    REQUIRE_FALSE( readManifest(path.string(), read) );
+    REQUIRE( read.digests.empty() );
+  }
+
+  SECTION("truncated manifest")
+  {
+    REQUIRE( writeManifest(path.string(), manifest) );
+    fs::resize_file(path / manifestFileName, fs::file_size(path / manifestFileName) - 1);
+
+    Manifest read;
+    REQUIRE_FALSE( readManifest(path.string(), read) );
+    REQUIRE( read.digests.empty() );
+  }
+
+  SECTION("remove manifest")
+  {
+    REQUIRE( writeManifest(path.string(), manifest) );
+    REQUIRE( removeManifest(path.string()) );
+    REQUIRE_FALSE( fs::exists(path / manifestFileName) );
+    // no manifest is not an error
+    REQUIRE( removeManifest(path.string()) );
+  }
+
+  SECTION("fingerprint changes with every setting")
+  {
+    const std::string tpl = "{..message..}";
+    const std::string url = "https://forum.example.com/";
+    const HTMLOptions defaults;
+    REQUIRE( fingerprint(tpl, defaults, url, smilies) == manifest.fingerprint );
+
+    REQUIRE( fingerprint("<p>{..message..}</p>", defaults, url, smilies) != manifest.fingerprint );
+    REQUIRE( fingerprint(tpl, defaults, "https://other.example.com/", smilies) != manifest.fingerprint );
+    REQUIRE( fingerprint(tpl, defaults, url, {}) != manifest.fingerprint );
+    REQUIRE( fingerprint(tpl, defaults, url, { Smilie(":)", "smile.gif", UrlType::Absolute) }) != manifest.fingerprint );
+
+    HTMLOptions options;
+    options.standard = HTMLStandard::XHTML;
+    REQUIRE( fingerprint(tpl, options, url, smilies) != manifest.fingerprint );
+    options = defaults;
+    options.nl2br = !options.nl2br;
+    REQUIRE( fingerprint(tpl, options, url, smilies) != manifest.fingerprint );
+    options = defaults;
+    options.noList = !options.noList;
+    REQUIRE( fingerprint(tpl, options, url, smilies) != manifest.fingerprint );
+    options = defaults;
+    options.tableClasses.useClasses = !options.tableClasses.useClasses;
+    REQUIRE( fingerprint(tpl, options, url, smilies) != manifest.fingerprint );
+    options = defaults;
+    options.tableClasses.cell = "other";
+    REQUIRE( fingerprint(tpl, options, url, smilies) != manifest.fingerprint );
+  }
+
+  fs::remove_all(path);
+}
@@ -0,0 +1,76 @@
+/*
+ -------------------------------------------------------------------------------
+    This file is part of the Private Message Database.
+    Copyright (C) 2026  Dirk Stolle
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ -------------------------------------------------------------------------------
+*/
+
+#include "../locate_catch.hpp"
+#include <string>
+#include <thread>
+#include <vector>
+#include "../../code/StringPool.hpp"
+
+TEST_CASE("string pool")
+{
+  using namespace pmdb;
+
+  SECTION("equal strings have the same address")
+  {
+    const std::string name = "Hermes";
+    const std::string& pooled = intern(name);
+    REQUIRE( pooled == name );
+    REQUIRE( &intern(std::string("Hermes")) == &pooled );
+    REQUIRE( &intern("Poseidon") != &pooled );
+    REQUIRE( intern("Poseidon") == "Poseidon" );
+  }
+
+  SECTION("empty string")
+  {
+    REQUIRE( intern("").empty() );
+    REQUIRE( &intern("") == &intern(std::string()) );
+  }
+
+  SECTION("pooling from several threads")
+  {
+    constexpr unsigned int threadCount = 4;
+    constexpr unsigned int names = 200;
+    std::vector<std::vector<const std::string*> > results(threadCount);
+    std::vector<std::thread> threads;
+    for (unsigned int t = 0; t < threadCount; ++t)
+    {
+      threads.emplace_back([&results, t]()
+      {
+        for (unsigned int i = 0; i < names; ++i)
+        {
+          results[t].push_back(&intern("user " + std::to_string(i)));
+        }
+      });
+    }
+    for (auto& thread: threads)
+    {
+      thread.join();
+    }
+    for (unsigned int t = 1; t < threadCount; ++t)
+    {
+      REQUIRE( results[t] == results[0] );
+    }
+    for (unsigned int i = 0; i < names; ++i)
+    {
+      REQUIRE( *results[0][i] == "user " + std::to_string(i) );
+    }
+  }
+}
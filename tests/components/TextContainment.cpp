@@ -0,0 +1,154 @@
+/*
+ -------------------------------------------------------------------------------
+    This file is part of the Private Message Database.
+    Copyright (C) 2026  Dirk Stolle
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ -------------------------------------------------------------------------------
+*/
+
+#include "../locate_catch.hpp"
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "../../code/TextContainment.hpp"
+
+/** \brief Finds contained texts by comparing every text with every other text. */
+std::vector<std::vector<std::size_t> > bruteForceContainedTexts(const std::vector<std::string_view>& texts)
+{
+  std::vector<std::vector<std::size_t> > result(texts.size());
+  for (std::size_t i = 0; i < texts.size(); ++i)
+  {
+    for (std::size_t j = 0; j < texts.size(); ++j)
+    {
+      if ((i != j) && (texts[i].find(texts[j]) != std::string_view::npos))
+        result[i].push_back(j);
+    }
+  }
+  return result;
+}
+
+TEST_CASE("TextContainment")
+{
+  using namespace pmdb::containment;
+
+  SECTION("no texts")
+  {
+    REQUIRE( findContainedTexts({}).empty() );
+  }
+
+  SECTION("short and long texts")
+  {
+    const std::vector<std::string_view> texts = {
+      "Hello!",
+      "Hello! How are you?",
+      "This is a longer text. Hello! How are you? I am fine, thanks.",
+      "I am fine",
+      "Hello! How are you?",
+      "completely unrelated message",
+      "Hello",
+      ""
+    };
+
+    const auto result = findContainedTexts(texts);
+    REQUIRE( result.size() == texts.size() );
+    REQUIRE( result[0] == std::vector<std::size_t>{ 6, 7 } );
+    REQUIRE( result[1] == std::vector<std::size_t>{ 0, 4, 6, 7 } );
+    REQUIRE( result[2] == std::vector<std::size_t>{ 0, 1, 3, 4, 6, 7 } );
+    REQUIRE( result[3] == std::vector<std::size_t>{ 7 } );
+    REQUIRE( result[4] == std::vector<std::size_t>{ 0, 1, 6, 7 } );
+    REQUIRE( result[5] == std::vector<std::size_t>{ 7 } );
+    REQUIRE( result[6] == std::vector<std::size_t>{ 7 } );
+    REQUIRE( result[7].empty() );
+  }
+
+  SECTION("long texts that differ only slightly")
+  {
+    const std::vector<std::string_view> texts = {
+      "The quick brown fox jumps over the lazy dog.",
+      "quick brown fox jumps over the lazy dog!",
+      "quick brown fox jumps over the lazy dog.",
+      "The quick brown fox jumps over the lazy dog..",
+      "The quick brown fox jumps over the lazy cat."
+    };
+
+    const auto result = findContainedTexts(texts);
+    REQUIRE( result.size() == texts.size() );
+    REQUIRE( result[0] == std::vector<std::size_t>{ 2 } );
+    REQUIRE( result[1].empty() );
+    REQUIRE( result[2].empty() );
+    REQUIRE( result[3] == std::vector<std::size_t>{ 0, 2 } );
+    REQUIRE( result[4].empty() );
+  }
+
+  SECTION("same result as brute force search")
+  {
+    // Texts over a small alphabet with shared building blocks produce a lot
+    // of containments and texts around the fingerprint length limit.
+    std::mt19937 generator(12345);
+    const std::vector<std::string> blocks = { "a", "ab", "ba", "abc", "hello ", "world", "\n", "aaaaaaaa" };
+    std::uniform_int_distribution<std::size_t> blockDistribution(0, blocks.size() - 1);
+    std::uniform_int_distribution<std::size_t> lengthDistribution(0, 12);
+
+    std::vector<std::string> storage;
+    for (unsigned int i = 0; i < 400; ++i)
+    {
+      std::string text;
+      const std::size_t count = lengthDistribution(generator);
+      for (std::size_t b = 0; b < count; ++b)
+      {
+        text += blocks[blockDistribution(generator)];
+      }
+      storage.push_back(text);
+    }
+    const std::vector<std::string_view> texts(storage.begin(), storage.end());
+
+    const auto expected = bruteForceContainedTexts(texts);
+    const unsigned int jobs = GENERATE(1, 4);
+    const auto result = findContainedTexts(texts, jobs);
+    REQUIRE( result.size() == expected.size() );
+    for (std::size_t i = 0; i < texts.size(); ++i)
+    {
+      REQUIRE( result[i] == expected[i] );
+    }
+  }
+
+  SECTION("progress is reported")
+  {
+    std::vector<std::string> storage;
+    for (unsigned int i = 0; i < 2000; ++i)
+    {
+      storage.push_back("message number " + std::to_string(i));
+    }
+    const std::vector<std::string_view> texts(storage.begin(), storage.end());
+
+    std::size_t lastDone = 0;
+    std::size_t lastTotal = 0;
+    bool increasing = true;
+    const auto progress = [&](const std::size_t done, const std::size_t total)
+    {
+      increasing = increasing && (done >= lastDone);
+      lastDone = done;
+      lastTotal = total;
+    };
+    const auto result = findContainedTexts(texts, 4, progress);
+    REQUIRE( result.size() == texts.size() );
+    // "message number 1" is contained in "message number 10" and others.
+    REQUIRE( result[10] == std::vector<std::size_t>{ 1 } );
+    REQUIRE( increasing );
+    REQUIRE( lastTotal > 0 );
+    REQUIRE( lastDone == lastTotal );
+  }
+}
@@ -0,0 +1,112 @@
+/*
+ -------------------------------------------------------------------------------
+    This file is part of the Private Message Database test suite.
+    Copyright (C) 2026  Dirk Stolle
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ -------------------------------------------------------------------------------
+*/
+
+#include "../locate_catch.hpp"
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include "../../code/VerificationCache.hpp"
+
+TEST_CASE("verification cache")
+{
+  namespace fs = std::filesystem;
+  using namespace pmdb::verification;
+
+  const fs::path path{fs::temp_directory_path() / "pmdb_verification_cache"};
+  fs::remove_all(path);
+  REQUIRE( fs::create_directory(path) );
+
+  SHA256::MessageDigest first;
+  REQUIRE( first.fromHexString("1111111111111111111111111111111111111111111111111111111111111111") );
+  SHA256::MessageDigest second;
+  REQUIRE( second.fromHexString("2222222222222222222222222222222222222222222222222222222222222222") );
+
+  Cache cache;
+  cache[first] = FileState{ 123, 4567 };
+  cache[second] = FileState{ 89, -10 };
+
+  SECTION("write and read cache")
+  {
+    const auto compression = GENERATE(Compression::none, Compression::zlib);
+    REQUIRE( writeCache(path.string(), compression, cache) );
+    REQUIRE( fs::exists(path / cacheFileName) );
+
+    Cache read;
+    REQUIRE( readCache(path.string(), compression, read) );
+    REQUIRE( read == cache );
+  }
+
+  SECTION("empty cache")
+  {
+    REQUIRE( writeCache(path.string(), Compression::none, Cache()) );
+
+    Cache read;
+    REQUIRE( readCache(path.string(), Compression::none, read) );
+    REQUIRE( read.empty() );
+  }
+
+  SECTION("cache for other compression is not used")
+  {
+    REQUIRE( writeCache(path.string(), Compression::zlib, cache) );
+
+    Cache read;
+    REQUIRE_FALSE( readCache(path.string(), Compression::none, read) );
+    REQUIRE( read.empty() );
+  }
+
+  SECTION("missing cache")
+  {
+    Cache read;
+    REQUIRE_FALSE( readCache(path.string(), Compression::none, read) );
+    REQUIRE( read.empty() );
+  }
+
+  SECTION("truncated cache")
+  {
+    REQUIRE( writeCache(path.string(), Compression::none, cache) );
+    fs::resize_file(path / cacheFileName, fs::file_size(path / cacheFileName) - 1);
+
+    Cache read;
+    REQUIRE_FALSE( readCache(path.string(), Compression::none, read) );
+    REQUIRE( read.empty() );
+  }
+
+  SECTION("file state")
+  {
+    const fs::path file = path / "file";
+    {
+      std::ofstream stream(file, std::ios::out | std::ios::binary);
+      stream << "some data";
+    }
+    FileState state;
+    REQUIRE( getFileState(file.string(), state) );
+    REQUIRE( state.size == 9 );
+
+    FileState changed;
+    fs::last_write_time(file, fs::last_write_time(file) - std::chrono::seconds(5));
+    REQUIRE( getFileState(file.string(), changed) );
+    REQUIRE( changed.size == 9 );
+    REQUIRE( changed != state );
+
+    REQUIRE_FALSE( getFileState((path / "does-not-exist").string(), state) );
+  }
+
+  fs::remove_all(path);
+}
@@ -0,0 +1,117 @@
+/*
+ -------------------------------------------------------------------------------
+    This file is part of the Private Message Database.
+    Copyright (C) 2026  Dirk Stolle
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ -------------------------------------------------------------------------------
+*/
+
+#include "../../locate_catch.hpp"
+#include <string>
+#include <vector>
+#include "../../../code/bbcode/PatternScanner.hpp"
+
+TEST_CASE("PatternScanner")
+{
+  SECTION("no patterns")
+  {
+    PatternScanner scanner;
+    REQUIRE( scanner.size() == 0 );
+    std::vector<bool> found(3, true);
+    scanner.scan("some text", found);
+    REQUIRE( found.empty() );
+  }
+
+  SECTION("duplicate patterns get the same index")
+  {
+    PatternScanner scanner;
+    REQUIRE( scanner.add("[b") == 0 );
+    REQUIRE( scanner.add("[/b") == 1 );
+    REQUIRE( scanner.add("[B") == 0 );
+    REQUIRE( scanner.size() == 2 );
+  }
+
+  SECTION("finds patterns, ignoring case")
+  {
+    PatternScanner scanner;
+    const std::size_t b = scanner.add("[b");
+    const std::size_t bEnd = scanner.add("[/b");
+    const std::size_t url = scanner.add("[URL");
+    const std::size_t smilie = scanner.add(":)");
+    std::vector<bool> found;
+
+    scanner.scan("", found);
+    REQUIRE( found == std::vector<bool>({ false, false, false, false }) );
+
+    scanner.scan("[B]bold[/b] :)", found);
+    REQUIRE( found[b] );
+    REQUIRE( found[bEnd] );
+    REQUIRE_FALSE( found[url] );
+    REQUIRE( found[smilie] );
+
+    scanner.scan("[ur [u [url=x]", found);
+    REQUIRE_FALSE( found[b] );
+    REQUIRE_FALSE( found[bEnd] );
+    REQUIRE( found[url] );
+    REQUIRE_FALSE( found[smilie] );
+  }
+
+  SECTION("overlapping patterns and patterns inside other patterns")
+  {
+    PatternScanner scanner;
+    const std::size_t sup = scanner.add("[sup");
+    const std::size_t s = scanner.add("[s");
+    const std::size_t up = scanner.add("up");
+    const std::size_t spoiler = scanner.add("[spoiler");
+    const std::size_t aab = scanner.add("aab");
+    std::vector<bool> found;
+
+    scanner.scan("x[[SUPER", found);
+    REQUIRE( found[sup] );
+    REQUIRE( found[s] );
+    REQUIRE( found[up] );
+    REQUIRE_FALSE( found[spoiler] );
+    REQUIRE_FALSE( found[aab] );
+
+    scanner.scan("[spoile aaab", found);
+    REQUIRE_FALSE( found[sup] );
+    REQUIRE( found[s] );
+    REQUIRE_FALSE( found[up] );
+    REQUIRE_FALSE( found[spoiler] );
+    REQUIRE( found[aab] );
+  }
+
+  SECTION("same result as searching each pattern")
+  {
+    PatternScanner scanner;
+    const std::vector<std::string> patterns = { "[b", "[/b", "[u", "[/u", "[url", "[/url", "[list", ":)", ";)", ":-)", "b]" };
+    for (const auto& pattern: patterns)
+    {
+      scanner.add(pattern);
+    }
+    const std::string alphabet = "[/bulrist:-);] x";
+    std::string text;
+    std::vector<bool> found;
+    for (unsigned int i = 0; i < 2000; ++i)
+    {
+      text.push_back(alphabet[(i * 7 + i / 3) % alphabet.length()]);
+      scanner.scan(text, found);
+      for (std::size_t idx = 0; idx < patterns.size(); ++idx)
+      {
+        REQUIRE( found[idx] == (text.find(patterns[idx]) != std::string::npos) );
+      }
+    }
+  }
+}
@@ -0,0 +1,98 @@
+/*
+ -------------------------------------------------------------------------------
+    This file is part of the Private Message Database.
+    Copyright (C) 2026  Dirk Stolle
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ -------------------------------------------------------------------------------
+*/
+
+#include "../../locate_catch.hpp"
+#include <map>
+#include "../../../code/bbcode/CustomizedSimpleBBCode.hpp"
+#include "../../../code/bbcode/SimpleBBCode.hpp"
+#include "../../../code/bbcode/SimpleTagReplacer.hpp"
+#include "../../../code/bbcode/SimpleTemplateBBCode.hpp"
+
+TEST_CASE("SimpleTagReplacer")
+{
+  SECTION("accepted and rejected codes")
+  {
+    SimpleTagReplacer replacer;
+    REQUIRE( replacer.empty() );
+
+    const SimpleBBCode b("b");
+    REQUIRE( replacer.add(b) );
+    REQUIRE_FALSE( replacer.empty() );
+    // same name again is fine
+    REQUIRE( replacer.add(SimpleBBCode("B")) );
+
+    // template codes do not have fixed replacements
+    const SimpleTemplateBBCode tpl("x", MsgTemplate("<x>{..inner..}</x>"));
+    REQUIRE_FALSE( replacer.add(tpl) );
+    // replacements with brackets could create new codes
+    REQUIRE_FALSE( replacer.add(CustomizedSimpleBBCode("y", "[b]", "</y>")) );
+    REQUIRE_FALSE( replacer.add(CustomizedSimpleBBCode("y", "<y>", "]")) );
+    // empty replacements could join brackets around them
+    REQUIRE_FALSE( replacer.add(CustomizedSimpleBBCode("y", "", "</y>")) );
+    // names with brackets or leading slash cannot be tokenized
+    REQUIRE_FALSE( replacer.add(SimpleBBCode("a]")) );
+    REQUIRE_FALSE( replacer.add(SimpleBBCode("/a")) );
+  }
+
+  SECTION("same result as applying the codes one after another")
+  {
+    const SimpleBBCode b("b");
+    const SimpleBBCode u("u");
+    const CustomizedSimpleBBCode s("s", "<span class=\"strike\">", "</span>");
+    const CustomizedSimpleBBCode sup("sup", "<sup>", "</sup>");
+    SimpleTagReplacer replacer;
+    REQUIRE( replacer.add(b) );
+    REQUIRE( replacer.add(u) );
+    REQUIRE( replacer.add(s) );
+    REQUIRE( replacer.add(sup) );
+
+    std::map<std::string, std::string> tests;
+    tests["This text should be unchanged."] = "This text should be unchanged.";
+    tests["[b]bold[/B] and [U]under[/u]"] = "<b>bold</b> and <u>under</u>";
+    tests["[b][u]nested[/u][/b]"] = "<b><u>nested</u></b>";
+    tests["[b]crossed [u]over[/b] codes[/u]"] = "<b>crossed <u>over</b> codes</u>";
+    tests["[s]strike[/s] x[sup]2[/sup]"] = "<span class=\"strike\">strike</span> x<sup>2</sup>";
+    // opening tag without closing tag stops the replacement for that code
+    tests["[b]one[/b] [b]two [b]three[/b]"] = "<b>one</b> <b>two [b]three</b>";
+    tests["[b]open [u]x[/u]"] = "[b]open <u>x</u>";
+    // closing tags before opening tags stay
+    tests["[/b]x[b]y[/b]"] = "[/b]x<b>y</b>";
+    // brackets around codes
+    tests["[[b]]x[[/b]]"] = "[<b>]x[</b>]";
+    tests["[b [b]x[/b"] = "[b [b]x[/b";
+    tests["[/[u]x[/u]"] = "[/<u>x</u>";
+    // unknown codes stay
+    tests["[i]x[/i] [sub]y[/sub]"] = "[i]x[/i] [sub]y[/sub]";
+
+    for (const auto& [key, value]: tests)
+    {
+      std::string text = key;
+      replacer.applyToText(text);
+      REQUIRE( text == value );
+
+      std::string sequential = key;
+      b.applyToText(sequential);
+      u.applyToText(sequential);
+      s.applyToText(sequential);
+      sup.applyToText(sequential);
+      REQUIRE( text == sequential );
+    }
+  }
+}
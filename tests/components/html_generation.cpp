@@ -1,7 +1,7 @@
 /*
  -------------------------------------------------------------------------------
     This file is part of the Private Message Database test suite.
-    Copyright (C) 2025  Dirk Stolle
+    Copyright (C) 2025, 2026  Dirk Stolle
 
     This program is free software: you can redistribute it and/or modify
     it under the terms of the GNU General Public License as published by
@@ -20,7 +20,11 @@
 
 #include "../locate_catch.hpp"
 #include <filesystem>
+#include <fstream>
+#include <sstream>
 #include "../../code/html_generation.hpp"
+#include "../../code/RenderManifest.hpp"
+#include "../../code/ReturnCodes.hpp"
 
 TEST_CASE("HTML generation")
 {
@@ -47,7 +51,7 @@ TEST_CASE("HTML generation")
 
       std::filesystem::path html_path = std::filesystem::temp_directory_path() / "pmdb_test_html_directory";
 
-      int exit_code = generateHtmlFiles(mdb, fm, options, html_path.string());
+      int exit_code = generateHtmlFiles(mdb, fm, options, 1, html_path.string());
       REQUIRE( exit_code == 0 );
 
       auto message_path = html_path / (pm.getHash().toHexString() + ".html");
@@ -58,9 +62,179 @@ TEST_CASE("HTML generation")
 
       REQUIRE( std::filesystem::remove(message_path) );
       REQUIRE( std::filesystem::remove(folder_path) );
+      REQUIRE( std::filesystem::remove(html_path / pmdb::manifest::manifestFileName) );
       REQUIRE( std::filesystem::remove(html_path) );
     }
 
+    SECTION("several jobs create the same files")
+    {
+      FolderMap fm;
+      MessageDatabase mdb;
+      // more messages than one thread handles at once
+      for (unsigned int i = 0; i < 300; ++i)
+      {
+        PrivateMessage pm;
+        pm.setDatestamp("2007-06-14 12:34");
+        pm.setTitle("Title <" + std::to_string(i) + ">");
+        pm.setFromUser("Hermes");
+        pm.setFromUserID(234);
+        pm.setToUser("Poseidon");
+        pm.setMessage("Message [b]number[/b] " + std::to_string(i) + ".\nSecond [u]line[/u] :)");
+        if (i % 3 == 0)
+          fm.add(pm.getHash(), "Folder " + std::to_string(i % 2));
+        REQUIRE( mdb.addMessage(pm) );
+      }
+
+      HTMLOptions options;
+      options.standard = HTMLStandard::XHTML;
+
+      const auto sequential_path = std::filesystem::temp_directory_path() / "pmdb_test_html_jobs_1";
+      const auto parallel_path = std::filesystem::temp_directory_path() / "pmdb_test_html_jobs_4";
+      REQUIRE( generateHtmlFiles(mdb, fm, options, 1, sequential_path.string()) == 0 );
+      REQUIRE( generateHtmlFiles(mdb, fm, options, 4, parallel_path.string()) == 0 );
+
+      const auto readFile = [](const std::filesystem::path& path)
+      {
+        std::ifstream stream(path, std::ios_base::in | std::ios_base::binary);
+        std::ostringstream content;
+        content << stream.rdbuf();
+        return content.str();
+      };
+      std::size_t files = 0;
+      for (const auto& entry: std::filesystem::directory_iterator(sequential_path))
+      {
+        const auto other = parallel_path / entry.path().filename();
+        REQUIRE( std::filesystem::is_regular_file(other) );
+        REQUIRE( readFile(entry.path()) == readFile(other) );
+        ++files;
+      }
+      // 300 messages, one index, two folders and the manifest
+      REQUIRE( files == 304 );
+
+      REQUIRE( std::filesystem::remove_all(sequential_path) == files + 1 );
+      REQUIRE( std::filesystem::remove_all(parallel_path) == files + 1 );
+    }
+
+    SECTION("unchanged messages are not created again")
+    {
+      FolderMap fm;
+      MessageDatabase mdb;
+
+      PrivateMessage pm;
+      pm.setDatestamp("2007-06-14 12:34");
+      pm.setTitle("This is the title");
+      pm.setFromUser("Hermes");
+      pm.setFromUserID(234);
+      pm.setToUser("Poseidon");
+      pm.setMessage("This is a [b]bold[/b] text.");
+      REQUIRE( mdb.addMessage(pm) );
+
+      HTMLOptions options;
+      options.standard = HTMLStandard::HTML4_01;
+
+      const auto html_path = std::filesystem::temp_directory_path() / "pmdb_test_html_manifest";
+      std::filesystem::remove_all(html_path);
+      REQUIRE( generateHtmlFiles(mdb, fm, options, 1, html_path.string()) == 0 );
+
+      pmdb::manifest::Manifest manifest;
+      REQUIRE( pmdb::manifest::readManifest(html_path.string(), manifest) );
+      REQUIRE( manifest.digests.size() == 1 );
+      REQUIRE( manifest.digests.count(pm.getHash()) == 1 );
+
+      // Mark the existing file, so that any new version can be detected.
+      const auto message_path = html_path / (pm.getHash().toHexString() + ".html");
+      const auto writeFile = [](const std::filesystem::path& path, const std::string& content)
+      {
+        std::ofstream stream(path, std::ios_base::out | std::ios_base::binary | std::ios_base::trunc);
+        stream << content;
+      };
+      const auto readFile = [](const std::filesystem::path& path)
+      {
+        std::ifstream stream(path, std::ios_base::in | std::ios_base::binary);
+        std::ostringstream content;
+        content << stream.rdbuf();
+        return content.str();
+      };
+      writeFile(message_path, "marker");
+
+      PrivateMessage second = pm;
+      second.setMessage("This is another text.");
+      REQUIRE( mdb.addMessage(second) );
+      const auto second_path = html_path / (second.getHash().toHexString() + ".html");
+
+      SECTION("same options")
+      {
+        REQUIRE( generateHtmlFiles(mdb, fm, options, 1, html_path.string()) == 0 );
+        REQUIRE( readFile(message_path) == "marker" );
+        REQUIRE( std::filesystem::is_regular_file(second_path) );
+        REQUIRE( pmdb::manifest::readManifest(html_path.string(), manifest) );
+        REQUIRE( manifest.digests.size() == 2 );
+      }
+
+      SECTION("missing file is created again")
+      {
+        REQUIRE( std::filesystem::remove(message_path) );
+        REQUIRE( generateHtmlFiles(mdb, fm, options, 1, html_path.string()) == 0 );
+        REQUIRE( std::filesystem::is_regular_file(message_path) );
+        REQUIRE( readFile(message_path) != "marker" );
+      }
+
+      SECTION("changed options")
+      {
+        options.standard = HTMLStandard::XHTML;
+        REQUIRE( generateHtmlFiles(mdb, fm, options, 1, html_path.string()) == 0 );
+        REQUIRE( readFile(message_path) != "marker" );
+        REQUIRE( std::filesystem::is_regular_file(second_path) );
+      }
+
+      std::filesystem::remove_all(html_path);
+    }
+
+    SECTION("failure: released text has been altered")
+    {
+      namespace fs = std::filesystem;
+      const auto messages_path = fs::temp_directory_path() / "pmdb_test_html_altered_messages";
+      const auto html_path = fs::temp_directory_path() / "pmdb_test_html_altered";
+      fs::remove_all(messages_path);
+      fs::remove_all(html_path);
+
+      FolderMap fm;
+      PrivateMessage pm;
+      {
+        MessageDatabase mdb;
+        for (unsigned int i = 0; i < 100; ++i)
+        {
+          pm.setDatestamp("2007-06-14 12:34");
+          pm.setTitle("Title " + std::to_string(i));
+          pm.setFromUser("Hermes");
+          pm.setFromUserID(234);
+          pm.setToUser("Poseidon");
+          pm.setMessage("Message number " + std::to_string(i) + ".");
+          REQUIRE( mdb.addMessage(pm) );
+        }
+        REQUIRE( fs::create_directory(messages_path) );
+        REQUIRE( mdb.saveMessages(messages_path.string(), Compression::none) );
+      }
+
+      MessageDatabase mdb;
+      uint32_t read_messages = 0;
+      uint32_t new_messages = 0;
+      REQUIRE( mdb.loadMessages(messages_path.string(), read_messages, new_messages, Compression::none, 1, Verification::Full, LoadMode::Headers) );
+      REQUIRE( read_messages == 100 );
+
+      // Only the text of the last message changes, the file name stays.
+      PrivateMessage altered = pm;
+      altered.setMessage("Another text.");
+      REQUIRE( altered.saveToFile((messages_path / pm.getHash().toHexString()).string(), Compression::none) );
+
+      HTMLOptions options;
+      const unsigned int jobs = GENERATE(1, 4);
+      REQUIRE( generateHtmlFiles(mdb, fm, options, jobs, html_path.string()) == rcFileError );
+
+      fs::remove_all(messages_path);
+      fs::remove_all(html_path);
+    }
+
     SECTION("no private message")
     {
       FolderMap fm;
@@ -71,7 +245,7 @@ TEST_CASE("HTML generation")
 
       std::filesystem::path html_path = std::filesystem::temp_directory_path() / "pmdb_test_html_directory_none";
 
-      int exit_code = generateHtmlFiles(mdb, fm, options, html_path.string());
+      int exit_code = generateHtmlFiles(mdb, fm, options, 1, html_path.string());
       REQUIRE( exit_code == 0 );
 
       REQUIRE_FALSE( std::filesystem::exists(html_path) );
@@ -0,0 +1,62 @@
+/*
+ -------------------------------------------------------------------------------
+    This file is part of the Private Message Database.
+    Copyright (C) 2026  Dirk Stolle
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ -------------------------------------------------------------------------------
+*/
+
+#include "../locate_catch.hpp"
+#include <string>
+#include "../../code/sha256_backend.hpp"
+#include "../../libstriezel/hash/sha256/BufferSource.hpp"
+
+TEST_CASE("sha256 backends")
+{
+  using namespace pmdb::sha256;
+
+  SECTION("portable backend is always supported")
+  {
+    REQUIRE( isSupported(Backend::Portable) );
+    REQUIRE( isSupported(fastestBackend()) );
+  }
+
+  SECTION("known digests")
+  {
+    REQUIRE( computeFromString("").toHexString() == "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855" );
+    REQUIRE( computeFromString("abc").toHexString() == "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad" );
+    REQUIRE( computeFromString("abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq").toHexString()
+             == "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1" );
+  }
+
+  SECTION("all supported backends give the same digests")
+  {
+    std::string data;
+    for (std::size_t length = 0; length <= 300; ++length)
+    {
+      SHA256::BufferSource portableSource(reinterpret_cast<uint8_t*>(data.data()), data.length() * 8);
+      const auto expected = computeFromSource(portableSource, Backend::Portable);
+
+      for (const auto backend: { Backend::Portable, Backend::ShaExtensions })
+      {
+        if (!isSupported(backend))
+          continue;
+        SHA256::BufferSource source(reinterpret_cast<uint8_t*>(data.data()), data.length() * 8);
+        REQUIRE( computeFromSource(source, backend) == expected );
+      }
+      data.push_back(static_cast<char>('a' + length % 26));
+    }
+  }
+}
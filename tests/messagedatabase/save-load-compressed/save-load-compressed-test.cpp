@@ -139,6 +139,35 @@ int main(int argc, char **argv)
     return 1;
   }
 
+  // save again with several threads, then clear and load once more
+  if (!mdb.saveMessages(tempDir, Compression::zlib, 4))
+  {
+    std::cerr << "Error: Could not save compressed messages to \"" << tempDir << "\" with four threads!\n";
+    return 1;
+  }
+  mdb.clear();
+  try
+  {
+    if (!mdb.loadMessages(tempDir, readMessages, newMessages, Compression::zlib))
+    {
+      std::cerr << "Error: Could not load compressed messages from \"" << tempDir << "\" a third time!\n";
+      return 1;
+    }
+  }
+  catch (...)
+  {
+    std::cerr << "Error: Caught exception while trying to load compressed messages a third time!\n";
+    return 1;
+  }
+  if ((readMessages != limit) || (newMessages != limit))
+  {
+    std::cout << "Error: Unexpected message count after saving with four threads!\n"
+              << "Expected " << limit << " messages in total (got "
+              << readMessages << ") and " << limit << " new messages (got "
+              << newMessages << ").\n";
+    return 1;
+  }
+
   std::cout << "Passed all MessageDatabase::saveMessages()/MessageDatabase::loadMessages() tests with compressed files.\n";
   return 0;
 }
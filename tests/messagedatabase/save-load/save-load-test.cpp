@@ -137,6 +137,30 @@ int main(int argc, char **argv)
     return 1;
   }
 
+  // clear and load again, this time with several threads
+  mdb.clear();
+  try
+  {
+    if (!mdb.loadMessages(tempDir, readMessages, newMessages, Compression::none, 4))
+    {
+      std::cerr << "Error: Could not load messages from \"" << tempDir << "\" with four threads!\n";
+      return 1;
+    }
+  }
+  catch (...)
+  {
+    std::cerr << "Error: Caught exception while trying to load messages with four threads!\n";
+    return 1;
+  }
+  if ((readMessages != limit) || (newMessages != limit) || (mdb.getNumberOfMessages() != limit))
+  {
+    std::cout << "Error: Unexpected message count after loading with four threads!\n"
+              << "Expected " << limit << " messages in total (got "
+              << readMessages << ") and " << limit << " new messages (got "
+              << newMessages << ").\n";
+    return 1;
+  }
+
   std::cout << "Passed all MessageDatabase::saveMessages()/MessageDatabase::loadMessages() tests with plain/uncompressed data files.\n";
   return 0;
 }
@@ -1,7 +1,7 @@
 /*
  -------------------------------------------------------------------------------
     This file is part of the Private Message Database test suite.
-    Copyright (C) 2015  Dirk Stolle
+    Copyright (C) 2015, 2026  Dirk Stolle
 
     This program is free software: you can redistribute it and/or modify
     it under the terms of the GNU General Public License as published by
@@ -113,6 +113,57 @@ int main()
   template_data.back().replacements.push_back(ReplData("what", "<html>", false));
   template_data.back().replacements.push_back(ReplData("what_else", "<html>", true));
 
+  // same tag several times and a tag without replacement
+  template_data.push_back(TplData("{..name..} meets {..other..} and {..name..}.",
+                                  std::vector<ReplData>(),
+                                  "Frodo meets {..other..} and Frodo."
+                                  ));
+  template_data.back().replacements.push_back(ReplData("name", "Frodo", false));
+
+  // later replacement for the same tag wins
+  template_data.push_back(TplData("The {..person..} is here.",
+                                  std::vector<ReplData>(),
+                                  "The wizard is here."
+                                  ));
+  template_data.back().replacements.push_back(ReplData("person", "hobbit", false));
+  template_data.back().replacements.push_back(ReplData("person", "wizard", false));
+
+  // incomplete tags and a tag inside an incomplete tag
+  template_data.push_back(TplData("{..a {..a..} ..} {..",
+                                  std::vector<ReplData>(),
+                                  "{..a X ..} {.."
+                                  ));
+  template_data.back().replacements.push_back(ReplData("a", "X", false));
+
+  // replacements that look like tags are not replaced again
+  template_data.push_back(TplData("{..a..}|{..b..}",
+                                  std::vector<ReplData>(),
+                                  "&#x7B;..b..&#x7D;|B"
+                                  ));
+  template_data.back().replacements.push_back(ReplData("a", "{..b..}", false));
+  template_data.back().replacements.push_back(ReplData("b", "B", false));
+
+  // tag markers in replacements are escaped, other braces stay
+  template_data.push_back(TplData("{..a..}",
+                                  std::vector<ReplData>(),
+                                  "&#x7B;..&#x7D; {.} ...&#x7D; {x}"
+                                  ));
+  template_data.back().replacements.push_back(ReplData("a", "{..} {.} ...} {x}", false));
+
+  // long replacement with characters to escape at several positions
+  template_data.push_back(TplData("[{..a..}]",
+                                  std::vector<ReplData>(),
+                                  "[&lt;p&gt;0123456789abcdef&amp;0123456789abcdef&lt;0123456789abcde&gt;&lt;/p&gt;]"
+                                  ));
+  template_data.back().replacements.push_back(ReplData("a", "<p>0123456789abcdef&0123456789abcdef<0123456789abcde></p>", true));
+
+  // long replacement without anything to escape
+  template_data.push_back(TplData("{..a..}",
+                                  std::vector<ReplData>(),
+                                  "This replacement is longer than sixteen characters & has <no> tags."
+                                  ));
+  template_data.back().replacements.push_back(ReplData("a", "This replacement is longer than sixteen characters & has <no> tags.", false));
+
 
   // Run through all the test data and check, whether it does match the expected result.
   unsigned int i;
@@ -134,6 +185,17 @@ int main()
                  << "Expected: \"" << template_data[i].expectedResultText << "\".\n";
        return 1;
     }
+
+    // render() has to append the same text to existing content.
+    std::string rendered = "prefix";
+    tpl.render(rendered);
+    if (rendered != "prefix" + template_data[i].expectedResultText)
+    {
+       std::cout << "Rendered output of template " << i << " does not match the expected text!\n";
+       std::cout << "Output:   \"" << rendered << "\".\n"
+                 << "Expected: \"prefix" << template_data[i].expectedResultText << "\".\n";
+       return 1;
+    }
   } //for i
 
   //success
@@ -1,6 +1,6 @@
 :: Script to test wrong values of parameters.
 ::
-::  Copyright (C) 2025  Dirk Stolle
+::  Copyright (C) 2025, 2026  Dirk Stolle
 ::
 ::  This program is free software: you can redistribute it and/or modify
 ::  it under the terms of the GNU General Public License as published by
@@ -157,6 +157,55 @@ if %ERRORLEVEL% NEQ 1 (
   exit /B 1
 )
 
+:: --full-save: parameter given twice
+"%EXECUTABLE%" --no-save --no-load-default --xml "%XML_FILE%" --full-save --full-save
+if %ERRORLEVEL% NEQ 1 (
+  echo Executable did not exit with code 1 when full-save option was given twice.
+  exit /B 1
+)
+
+:: --store: parameter given twice
+"%EXECUTABLE%" --no-save --no-load-default --xml "%XML_FILE%" --store=pack --store=pack
+if %ERRORLEVEL% NEQ 1 (
+  echo Executable did not exit with code 1 when store option was given twice.
+  exit /B 1
+)
+
+:: --store: unknown storage type
+"%EXECUTABLE%" --no-save --no-load-default --xml "%XML_FILE%" --store=database
+if %ERRORLEVEL% NEQ 1 (
+  echo Executable did not exit with code 1 when store option had an unknown type.
+  exit /B 1
+)
+
+:: --jobs: parameter given twice
+"%EXECUTABLE%" --no-save --no-load-default --xml "%XML_FILE%" --jobs=2 --jobs=2
+if %ERRORLEVEL% NEQ 1 (
+  echo Executable did not exit with code 1 when jobs option was given twice.
+  exit /B 1
+)
+
+:: --jobs: zero jobs
+"%EXECUTABLE%" --no-save --no-load-default --xml "%XML_FILE%" --jobs=0
+if %ERRORLEVEL% NEQ 1 (
+  echo Executable did not exit with code 1 when jobs option was zero.
+  exit /B 1
+)
+
+:: --jobs: value is not a number
+"%EXECUTABLE%" --no-save --no-load-default --xml "%XML_FILE%" --jobs=abc
+if %ERRORLEVEL% NEQ 1 (
+  echo Executable did not exit with code 1 when jobs option was not a number.
+  exit /B 1
+)
+
+:: --jobs: value is too large
+"%EXECUTABLE%" --no-save --no-load-default --xml "%XML_FILE%" --jobs=1025
+if %ERRORLEVEL% NEQ 1 (
+  echo Executable did not exit with code 1 when jobs option was too large.
+  exit /B 1
+)
+
 :: --no-open: parameter given twice
 "%EXECUTABLE%" --no-save --no-load-default --xml "%XML_FILE%" --html --no-open --no-open
 if %ERRORLEVEL% NEQ 1 (
@@ -2,7 +2,7 @@
 
 # Script to test wrong values of parameters.
 #
-#  Copyright (C) 2025  Dirk Stolle
+#  Copyright (C) 2025, 2026  Dirk Stolle
 #
 #  This program is free software: you can redistribute it and/or modify
 #  it under the terms of the GNU General Public License as published by
@@ -177,6 +177,62 @@ then
   exit 1
 fi
 
+# --full-save: parameter given twice
+"$EXECUTABLE" --no-save --no-load-default --xml "$XML_FILE" --full-save --full-save
+if [ $? -ne 1 ]
+then
+  echo "Executable did not exit with code 1 when --full-save was given twice."
+  exit 1
+fi
+
+# --store: parameter given twice
+"$EXECUTABLE" --no-save --no-load-default --xml "$XML_FILE" --store=pack --store=pack
+if [ $? -ne 1 ]
+then
+  echo "Executable did not exit with code 1 when --store was given twice."
+  exit 1
+fi
+
+# --store: unknown storage type
+"$EXECUTABLE" --no-save --no-load-default --xml "$XML_FILE" --store=database
+if [ $? -ne 1 ]
+then
+  echo "Executable did not exit with code 1 when --store had an unknown type."
+  exit 1
+fi
+
+# --jobs: parameter given twice
+"$EXECUTABLE" --no-save --no-load-default --xml "$XML_FILE" --jobs=2 --jobs=2
+if [ $? -ne 1 ]
+then
+  echo "Executable did not exit with code 1 when --jobs was given twice."
+  exit 1
+fi
+
+# --jobs: zero jobs
+"$EXECUTABLE" --no-save --no-load-default --xml "$XML_FILE" --jobs=0
+if [ $? -ne 1 ]
+then
+  echo "Executable did not exit with code 1 when --jobs was zero."
+  exit 1
+fi
+
+# --jobs: value is not a number
+"$EXECUTABLE" --no-save --no-load-default --xml "$XML_FILE" --jobs=abc
+if [ $? -ne 1 ]
+then
+  echo "Executable did not exit with code 1 when --jobs was not a number."
+  exit 1
+fi
+
+# --jobs: value is too large
+"$EXECUTABLE" --no-save --no-load-default --xml "$XML_FILE" --jobs=1025
+if [ $? -ne 1 ]
+then
+  echo "Executable did not exit with code 1 when --jobs was too large."
+  exit 1
+fi
+
 # --no-open: parameter given twice
 "$EXECUTABLE" --no-save --no-load-default --xml "$XML_FILE" --html --no-open --no-open
 if [ $? -ne 1 ]